@@ -22,7 +22,8 @@ public class GStreamerPlugin : ModuleRules
 
         PrivateDependencyModuleNames.AddRange(new string[]
         {
-            "Projects"
+            "Projects",
+            "GStreamerShaders"
         });
 
         string GStreamerPath = Path.Combine(ModuleDirectory, "../../ThirdParty/GStreamer");
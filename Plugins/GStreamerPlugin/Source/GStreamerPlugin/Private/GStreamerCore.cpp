@@ -4,6 +4,7 @@
 
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
+#include <gst/video/video.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -116,6 +117,52 @@ extern "C" bool GStreamerGetVideoDimensions(void* caps, int* width, int* height)
         gst_structure_get_int(structure, "height", height);
 }
 
+// Pixel formats reported by GStreamerGetSampleLayout, matching EGStreamerPixelFormat
+#define GSTREAMER_PIXEL_FORMAT_UNKNOWN 0
+#define GSTREAMER_PIXEL_FORMAT_RGBA    1
+#define GSTREAMER_PIXEL_FORMAT_NV12    2
+#define GSTREAMER_PIXEL_FORMAT_I420    3
+
+// Get the pixel format and plane layout of a sample. Offsets and strides come from the
+// buffer's video meta when it has one, since decoders may pad rows or planes.
+extern "C" bool GStreamerGetSampleLayout(void* sample, int* format, int* num_planes, int* offsets, int* strides)
+{
+    if (!sample) return false;
+
+    GstVideoInfo info;
+    if (!gst_video_info_from_caps(&info, gst_sample_get_caps(GST_SAMPLE(sample)))) {
+        return false;
+    }
+
+    switch (GST_VIDEO_INFO_FORMAT(&info)) {
+    case GST_VIDEO_FORMAT_RGBA:
+    case GST_VIDEO_FORMAT_BGRA:
+        *format = GSTREAMER_PIXEL_FORMAT_RGBA;
+        break;
+    case GST_VIDEO_FORMAT_NV12:
+        *format = GSTREAMER_PIXEL_FORMAT_NV12;
+        break;
+    case GST_VIDEO_FORMAT_I420:
+        *format = GSTREAMER_PIXEL_FORMAT_I420;
+        break;
+    default:
+        *format = GSTREAMER_PIXEL_FORMAT_UNKNOWN;
+        break;
+    }
+
+    int planes = (int)GST_VIDEO_INFO_N_PLANES(&info);
+    if (planes > 3) planes = 3;
+    *num_planes = planes;
+
+    GstBuffer* buffer = gst_sample_get_buffer(GST_SAMPLE(sample));
+    GstVideoMeta* meta = buffer ? gst_buffer_get_video_meta(buffer) : nullptr;
+    for (int i = 0; i < planes; i++) {
+        offsets[i] = meta ? (int)meta->offset[i] : (int)GST_VIDEO_INFO_PLANE_OFFSET(&info, i);
+        strides[i] = meta ? meta->stride[i] : GST_VIDEO_INFO_PLANE_STRIDE(&info, i);
+    }
+    return true;
+}
+
 // Map buffer and copy data
 extern "C" bool GStreamerCopyBufferData(void* buffer, unsigned char* dest, int size)
 {
@@ -133,6 +180,48 @@ extern "C" bool GStreamerCopyBufferData(void* buffer, unsigned char* dest, int s
     return true;
 }
 
+// Sample kept alive with its buffer mapped for reading, so the decoded image can be
+// used in place instead of being copied out first
+struct GStreamerMappedSample
+{
+    GstSample* sample;
+    GstBuffer* buffer;
+    GstMapInfo map;
+};
+
+// Map a sample's buffer. Takes its own reference to the sample, so the caller still frees theirs.
+// Returns a handle for GStreamerUnmapSample, or null if the sample has no mappable buffer.
+extern "C" void* GStreamerMapSample(void* sample, const unsigned char** data, int* size)
+{
+    if (!sample || !data || !size) return nullptr;
+
+    GstBuffer* buffer = gst_sample_get_buffer(GST_SAMPLE(sample));
+    if (!buffer) return nullptr;
+
+    GStreamerMappedSample* mapped = g_new0(GStreamerMappedSample, 1);
+    if (!gst_buffer_map(buffer, &mapped->map, GST_MAP_READ)) {
+        g_free(mapped);
+        return nullptr;
+    }
+    mapped->sample = gst_sample_ref(GST_SAMPLE(sample));
+    mapped->buffer = buffer;
+
+    *data = mapped->map.data;
+    *size = (int)mapped->map.size;
+    return mapped;
+}
+
+// Unmap and release a sample mapped by GStreamerMapSample. May be called from any thread.
+extern "C" void GStreamerUnmapSample(void* mapped_sample)
+{
+    if (!mapped_sample) return;
+
+    GStreamerMappedSample* mapped = (GStreamerMappedSample*)mapped_sample;
+    gst_buffer_unmap(mapped->buffer, &mapped->map);
+    gst_sample_unref(mapped->sample);
+    g_free(mapped);
+}
+
 // Get buffer size
 extern "C" int GStreamerGetBufferSize(void* buffer)
 {
@@ -1,4 +1,5 @@
 #include "GStreamerVideoReceiver.h"
+#include "GStreamerYUVConverter.h"
 #include "RenderingThread.h"
 #include "RenderCommandFence.h"
 #include "TextureResource.h"
@@ -6,6 +7,118 @@
 #include "RHI.h"
 #include <string>
 
+//=============================================================================
+// FGStreamerMappedSample Implementation
+//=============================================================================
+
+bool FGStreamerMappedSample::Map(void* Sample)
+{
+    Reset();
+
+    const unsigned char* MappedData = nullptr;
+    int MappedSize = 0;
+    Handle = GStreamerMapSample(Sample, &MappedData, &MappedSize);
+    if (!Handle)
+    {
+        return false;
+    }
+
+    Data = MappedData;
+    Size = MappedSize;
+    return true;
+}
+
+void FGStreamerMappedSample::Reset()
+{
+    if (Handle)
+    {
+        GStreamerUnmapSample(Handle);
+        Handle = nullptr;
+        Data = nullptr;
+        Size = 0;
+    }
+}
+
+/** Fill OutFrame from a pulled sample without copying its pixels. Returns false for unusable samples. */
+static bool MapVideoFrame(void* Sample, FVideoFrame& OutFrame)
+{
+    int Width, Height;
+    if (!GStreamerGetVideoDimensions(GStreamerGetSampleCaps(Sample), &Width, &Height))
+    {
+        return false;
+    }
+
+    if (!OutFrame.Sample.Map(Sample) || OutFrame.Sample.GetSize() <= 0 || OutFrame.Sample.GetSize() > (Width * Height * 4 * 2))
+    {
+        OutFrame.Sample.Reset();
+        return false;
+    }
+
+    int Format = 0, NumPlanes = 0;
+    int Offsets[3] = {}, Strides[3] = {};
+    if (!GStreamerGetSampleLayout(Sample, &Format, &NumPlanes, Offsets, Strides))
+    {
+        OutFrame.Sample.Reset();
+        return false;
+    }
+
+    OutFrame.Width = Width;
+    OutFrame.Height = Height;
+    OutFrame.Timestamp = FPlatformTime::Seconds();
+    OutFrame.Format = static_cast<EGStreamerPixelFormat>(Format);
+    OutFrame.NumPlanes = NumPlanes;
+    for (int32 Index = 0; Index < 3; ++Index)
+    {
+        OutFrame.PlaneOffsets[Index] = Offsets[Index];
+        OutFrame.PlaneStrides[Index] = Strides[Index];
+    }
+    return true;
+}
+
+//=============================================================================
+// FVideoFramePool Implementation
+//=============================================================================
+
+FVideoFrame* FVideoFramePool::Acquire()
+{
+    uint32 Free = FreeMask.Load();
+    while (Free != 0)
+    {
+        const uint32 Slot = FMath::CountTrailingZeros(Free);
+        if (FreeMask.CompareExchange(Free, Free & ~(1u << Slot)))
+        {
+            return &Slots[Slot];
+        }
+        // CompareExchange reloaded Free, try again
+    }
+
+    ++ExhaustedCount;
+    return nullptr;
+}
+
+void FVideoFramePool::Publish(FVideoFrame* Frame)
+{
+    const int32 Previous = Latest.Exchange(static_cast<int32>(Frame - Slots));
+    if (Previous != INDEX_NONE)
+    {
+        ++SupersededCount;
+        Release(&Slots[Previous]);
+    }
+}
+
+FVideoFrame* FVideoFramePool::TakeLatest()
+{
+    const int32 Slot = Latest.Exchange(INDEX_NONE);
+    return Slot != INDEX_NONE ? &Slots[Slot] : nullptr;
+}
+
+void FVideoFramePool::Release(FVideoFrame* Frame)
+{
+    // Hand the buffer back to the decoder before the slot can be reused
+    Frame->Sample.Reset();
+    FreeMask |= 1u << static_cast<uint32>(Frame - Slots);
+}
+
 //=============================================================================
 // FFramePullRunnable Implementation
 //=============================================================================
@@ -26,37 +139,20 @@ uint32 FFramePullRunnable::Run()
             continue;
         }
         
-        void* buffer = GStreamerGetSampleBuffer(sample);
-        void* caps = GStreamerGetSampleCaps(sample);
-        
-        if (buffer && caps)
+        // The frame keeps its own reference to the sample, mapped, until it has been uploaded.
+        // With every slot in use the new frame is dropped; the pool counts it.
+        FVideoFrame* Frame = FramePool.Acquire();
+        if (Frame)
         {
-            int width, height;
-            if (GStreamerGetVideoDimensions(caps, &width, &height))
+            if (MapVideoFrame(sample, *Frame))
             {
-                FVideoFrame Frame;
-                Frame.Width = width;
-                Frame.Height = height;
-                Frame.Timestamp = FPlatformTime::Seconds();
-                
-                int bufferSize = GStreamerGetBufferSize(buffer);
-                if (bufferSize <= 0 || bufferSize > (width * height * 4 * 2))
-                {
-                    GStreamerFreeSample(sample);
-                    continue;
-                }
-                Frame.Data.SetNumUninitialized(bufferSize);
-                GStreamerCopyBufferData(buffer, Frame.Data.GetData(), bufferSize);
-                
-                // Drop old frames - only keep the latest
-                // This ensures we always display the most recent frame for lowest latency
-                FVideoFrame Temp;
-                while (FrameQueue.Dequeue(Temp)) 
-                {
-                    // Drain any old frames
-                }
-                
-                FrameQueue.Enqueue(MoveTemp(Frame));
+                // Only keep the latest frame for lowest latency: publishing releases an older
+                // one the game thread has not taken yet, handing its buffer back to the decoder
+                FramePool.Publish(Frame);
+            }
+            else
+            {
+                FramePool.Release(Frame);
             }
         }
         
@@ -67,11 +163,6 @@ uint32 FFramePullRunnable::Run()
     return 0;
 }
 
-bool FFramePullRunnable::PopFrame(FVideoFrame& OutFrame)
-{
-    return FrameQueue.Dequeue(OutFrame);
-}
-
 //=============================================================================
 // FGStreamerVideoReceiver Implementation
 //=============================================================================
@@ -87,6 +178,7 @@ FGStreamerVideoReceiver::FGStreamerVideoReceiver()
     , FrameCount(0)
     , LastFPSUpdateTime(0.0)
     , CurrentFPS(0)
+    , YUVConverter(MakeUnique<FGStreamerYUVConverter>())
     , bUseBackgroundThread(false)
 {
 }
@@ -95,6 +187,12 @@ FGStreamerVideoReceiver::~FGStreamerVideoReceiver()
 {
     Stop();
 
+    // A pending upload still reads from a pool slot and releases it when done
+    if (UploadsInFlight.Load() > 0)
+    {
+        FlushRenderingCommands();
+    }
+
     if (Bus)
     {
         GStreamerUnrefBus(Bus);
@@ -132,8 +230,8 @@ bool FGStreamerVideoReceiver::Initialize(int32 Port, int SRTLatencyMs, bool bUse
             "tsdemux ! h264parse ! "
             "nvh264dec ! "
             "cudadownload ! "
-            "videoconvert n-threads=4 ! "
-            "video/x-raw,format=RGBA ! "
+            "videoconvert ! "
+            "video/x-raw,format=NV12 ! "  // decoder's native layout, videoconvert passes it through
             "appsink name=sink emit-signals=false sync=false max-buffers=1 drop=true";
         // UDP + RTP approach
         /*
@@ -160,7 +258,7 @@ bool FGStreamerVideoReceiver::Initialize(int32 Port, int SRTLatencyMs, bool bUse
             "rtph264depay ! h264parse ! "
             "avdec_h264 ! "
             "videoconvert ! "
-            "video/x-raw,format=BGRA ! "  // BGRA matches Unreal's PF_R8G8B8A8 on PC
+            "video/x-raw,format=I420 ! "  // decoder's native layout, converted to RGBA on the GPU
             "appsink name=sink emit-signals=false sync=false max-buffers=2 drop=true";
         
         bUseBackgroundThread = true;
@@ -221,7 +319,7 @@ bool FGStreamerVideoReceiver::Start()
     // Start background frame pulling thread if enabled
     if (bUseBackgroundThread && AppSink)
     {
-        FramePullRunnable = MakeUnique<FFramePullRunnable>(AppSink);
+        FramePullRunnable = MakeUnique<FFramePullRunnable>(AppSink, FramePool);
         FramePullThread = TUniquePtr<FRunnableThread>(
             FRunnableThread::Create(
                 FramePullRunnable.Get(),
@@ -266,45 +364,32 @@ void FGStreamerVideoReceiver::Stop()
     }
 }
 
-bool FGStreamerVideoReceiver::UpdateTexture(UTexture2D* Texture)
+bool FGStreamerVideoReceiver::UpdateTexture(UTextureRenderTarget2D* Target)
 {
-    if (!Texture || !AppSink) { return false; }
+    if (!Target || !AppSink) { return false; }
 
-    FVideoFrame Frame;
-    bool bHasNewFrame = false;
+    // Taken from the pool; every path below must release it, or hand it to the upload
+    FVideoFrame* Frame = nullptr;
     
     if (bUseBackgroundThread && FramePullRunnable) {
-        bHasNewFrame = FramePullRunnable->PopFrame(Frame);
+        Frame = FramePullRunnable->PopFrame();
     }
     else {
         // Direct pull on game thread (blocking) - use timeout version
         void* sample = GStreamerTryPullSample(AppSink, 0.001); // 1ms timeout max
         if (sample)
         {
-            void* buffer = GStreamerGetSampleBuffer(sample);
-            void* caps = GStreamerGetSampleCaps(sample);
-            
-            if (buffer && caps)
+            Frame = FramePool.Acquire();
+            if (Frame && !MapVideoFrame(sample, *Frame))
             {
-                int width, height;
-                if (GStreamerGetVideoDimensions(caps, &width, &height))
-                {
-                    Frame.Width = width;
-                    Frame.Height = height;
-                    
-                    int bufferSize = GStreamerGetBufferSize(buffer);
-                    Frame.Data.SetNumUninitialized(bufferSize);
-                    GStreamerCopyBufferData(buffer, Frame.Data.GetData(), bufferSize);
-                    
-                    bHasNewFrame = true;
-                }
+                FramePool.Release(Frame);
+                Frame = nullptr;
             }
-            
             GStreamerFreeSample(sample);
         }
     }
     
-    if (!bHasNewFrame)
+    if (!Frame)
     {
         return false; // No new frame available
     }
@@ -320,51 +405,73 @@ bool FGStreamerVideoReceiver::UpdateTexture(UTexture2D* Texture)
     }
 
     // Update stored dimensions
-    VideoWidth = Frame.Width;
-    VideoHeight = Frame.Height;
+    VideoWidth = Frame->Width;
+    VideoHeight = Frame->Height;
 
-    if (!Texture->GetResource() || !Texture->GetResource()->TextureRHI) {
+    // Uploads are queued behind each other on the render thread; only skip a frame
+    // when the render thread has fallen a full MaxUploadsInFlight frames behind
+    if (UploadsInFlight.Load() >= MaxUploadsInFlight)
+    {
+        ++UploadsSkipped;
+        FramePool.Release(Frame);
         return false;
     }
 
-    if (bUpdateInFlight)
-    {
-        return false;  // Previous update still processing, skip this frame
+    // Guard: YUV frames need every plane inside the buffer, packed frames exactly width*height*4
+    const bool bYUV = FGStreamerYUVConverter::SupportsFormat(*Frame);
+    if (bYUV ? !FGStreamerYUVConverter::HasCompletePlanes(*Frame) : Frame->Format != EGStreamerPixelFormat::RGBA) {
+        UE_LOG(LogTemp, Warning, TEXT("Frame layout unsupported or truncated: format %d, %d planes, %d bytes"),
+            static_cast<int32>(Frame->Format), Frame->NumPlanes, Frame->Sample.GetSize());
+        FramePool.Release(Frame);
+        return false;
     }
-
-    bUpdateInFlight = true;
-
-    // Guard: frame must match texture dimensions exactly
-    if (Frame.Width != Texture->GetSizeX() || Frame.Height != Texture->GetSizeY()) {
-        UE_LOG(LogTemp, Warning, TEXT("Frame/texture size mismatch: frame=%dx%d tex=%dx%d"), Frame.Width, Frame.Height, Texture->GetSizeX(), Texture->GetSizeY());
-        bUpdateInFlight = false;
+    if (!bYUV && Frame->Sample.GetSize() != Frame->Width * Frame->Height * 4) {
+        UE_LOG(LogTemp, Warning, TEXT("Frame data size unexpected: %d vs expected %d"), Frame->Sample.GetSize(), Frame->Width * Frame->Height * 4);
+        FramePool.Release(Frame);
         return false;
     }
 
-    // Guard: data size must be exactly width*height*4
-    if (Frame.Data.Num() != Frame.Width * Frame.Height * 4) {
-        UE_LOG(LogTemp, Warning, TEXT("Frame data size unexpected: %d vs expected %d"), Frame.Data.Num(), Frame.Width * Frame.Height * 4);
-        bUpdateInFlight = false;
-        return false;
+    // Follow the stream's resolution. The target is reallocated in place on the render
+    // thread, ahead of the upload below, so this frame is not dropped.
+    if (Frame->Width != Target->SizeX || Frame->Height != Target->SizeY) {
+        UE_LOG(LogTemp, Log, TEXT("Resizing video target: %dx%d -> %dx%d"), Target->SizeX, Target->SizeY, Frame->Width, Frame->Height);
+        Target->ResizeTarget(Frame->Width, Frame->Height);
     }
 
-    FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(0, 0, 0, 0, Frame.Width, Frame.Height);
-    TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> ImageDataPtr = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(Frame.Data));
+    FTextureResource* Resource = Target->GetResource();
+    if (!Resource) {
+        FramePool.Release(Frame);
+        return false;
+    }
 
-    TAtomic<bool>* FlagPtr = &bUpdateInFlight;
-    Texture->UpdateTextureRegions(
-        0,
-        1,
-        Region,
-        Frame.Width * 4,
-        4,
-        ImageDataPtr->GetData(),
-        [Region, ImageDataPtr, FlagPtr](auto* Data, const FUpdateTextureRegion2D* Regions)
+    // Upload straight from the mapped GStreamer buffer, which serves as the staging memory:
+    // the slot stays out of the pool, and the buffer mapped, until the render thread has
+    // copied it into the RHI's upload memory. The target's RHI texture is resolved on the
+    // render thread, after any pending resize; its release is queued behind this command.
+    // YUV frames are converted to RGBA by drawing straight into the target.
+    FGStreamerYUVConverter* Converter = YUVConverter.Get();
+    FVideoFramePool* Pool = &FramePool;
+    TAtomic<int32>* InFlightPtr = &UploadsInFlight;
+    ++UploadsInFlight;
+
+    ENQUEUE_RENDER_COMMAND(GStreamerUploadFrame)(
+        [Resource, Converter, bYUV, Frame, Pool, InFlightPtr](FRHICommandListImmediate& RHICmdList)
         {
-            delete Region;
-            *FlagPtr = false;
-        }
-    );
+            if (FRHITexture* TextureRHI = Resource->GetTexture2DRHI())
+            {
+                if (bYUV)
+                {
+                    Converter->Convert(RHICmdList, *Frame, TextureRHI);
+                }
+                else
+                {
+                    const FUpdateTextureRegion2D Region(0, 0, 0, 0, Frame->Width, Frame->Height);
+                    RHICmdList.UpdateTexture2D(TextureRHI, 0, Region, Frame->Width * 4, Frame->Sample.GetData());
+                }
+            }
+            Pool->Release(Frame);
+            --(*InFlightPtr);
+        });
 
     return true;
 }
@@ -429,6 +536,9 @@ FGStreamerStats FGStreamerVideoReceiver::GetStatistics()
     }
 
     Stats.CurrentFPS = CurrentFPS;
+    Stats.FramePoolExhausted = FramePool.GetExhaustedCount();
+    Stats.FramesSuperseded = FramePool.GetSupersededCount();
+    Stats.FramesSkippedUploading = UploadsSkipped;
 
     return Stats;
 }
\ No newline at end of file
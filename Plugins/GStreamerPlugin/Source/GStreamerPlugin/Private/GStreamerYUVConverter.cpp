@@ -0,0 +1,142 @@
+#include "GStreamerYUVConverter.h"
+#include "GStreamerVideoReceiver.h"
+#include "GStreamerShaders.h"
+#include "RHICommandList.h"
+#include "RHIStaticStates.h"
+#include "PipelineStateCache.h"
+#include "CommonRenderResources.h"
+#include "GlobalShader.h"
+
+namespace
+{
+    /** Size of plane Index of a 4:2:0 frame; chroma planes round up for odd sizes */
+    FIntPoint PlaneSize(const FVideoFrame& Frame, int32 Index)
+    {
+        return Index == 0
+            ? FIntPoint(Frame.Width, Frame.Height)
+            : FIntPoint((Frame.Width + 1) / 2, (Frame.Height + 1) / 2);
+    }
+
+    /** Bytes per texel of plane Index */
+    int32 PlaneTexelBytes(const FVideoFrame& Frame, int32 Index)
+    {
+        return (Frame.Format == EGStreamerPixelFormat::NV12 && Index == 1) ? 2 : 1;
+    }
+
+    FTextureRHIRef CreatePlaneTexture(const TCHAR* Name, FIntPoint Size, EPixelFormat Format, ETextureCreateFlags Flags)
+    {
+        const FRHITextureCreateDesc Desc = FRHITextureCreateDesc::Create2D(Name)
+            .SetExtent(Size)
+            .SetFormat(Format)
+            .SetNumMips(1)
+            .SetFlags(Flags)
+            .SetInitialState(ERHIAccess::SRVGraphics);
+        return RHICreateTexture(Desc);
+    }
+}
+
+bool FGStreamerYUVConverter::SupportsFormat(const FVideoFrame& Frame)
+{
+    return (Frame.Format == EGStreamerPixelFormat::NV12 && Frame.NumPlanes == 2) ||
+        (Frame.Format == EGStreamerPixelFormat::I420 && Frame.NumPlanes == 3);
+}
+
+bool FGStreamerYUVConverter::HasCompletePlanes(const FVideoFrame& Frame)
+{
+    for (int32 Index = 0; Index < Frame.NumPlanes; ++Index)
+    {
+        const FIntPoint Size = PlaneSize(Frame, Index);
+        const int64 RowBytes = static_cast<int64>(Size.X) * PlaneTexelBytes(Frame, Index);
+        const int64 End = Frame.PlaneOffsets[Index] + static_cast<int64>(Frame.PlaneStrides[Index]) * (Size.Y - 1) + RowBytes;
+
+        if (Frame.PlaneOffsets[Index] < 0 || Frame.PlaneStrides[Index] < RowBytes || End > Frame.Sample.GetSize())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FGStreamerYUVConverter::EnsureTextures(FRHICommandListImmediate& RHICmdList, const FVideoFrame& Frame)
+{
+    const FIntPoint Size(Frame.Width, Frame.Height);
+    const int32 Format = static_cast<int32>(Frame.Format);
+    if (LumaTexture.IsValid() && Size == TextureSize && Format == TextureFormat)
+    {
+        return;
+    }
+
+    const ETextureCreateFlags PlaneFlags = ETextureCreateFlags::ShaderResource | ETextureCreateFlags::Dynamic;
+    const bool bPlanarChroma = Frame.Format == EGStreamerPixelFormat::I420;
+
+    LumaTexture = CreatePlaneTexture(TEXT("GStreamerLuma"), PlaneSize(Frame, 0), PF_G8, PlaneFlags);
+    ChromaTexture = CreatePlaneTexture(TEXT("GStreamerChroma"), PlaneSize(Frame, 1), bPlanarChroma ? PF_G8 : PF_R8G8, PlaneFlags);
+    ChromaVTexture = bPlanarChroma
+        ? CreatePlaneTexture(TEXT("GStreamerChromaV"), PlaneSize(Frame, 2), PF_G8, PlaneFlags)
+        : nullptr;
+
+    TextureSize = Size;
+    TextureFormat = Format;
+
+    UE_LOG(LogTemp, Log, TEXT("GStreamer: GPU color conversion textures %dx%d (%s)"),
+        Size.X, Size.Y, bPlanarChroma ? TEXT("I420") : TEXT("NV12"));
+}
+
+void FGStreamerYUVConverter::Convert(FRHICommandListImmediate& RHICmdList, const FVideoFrame& Frame, FRHITexture* Destination)
+{
+    if (!Destination || !SupportsFormat(Frame))
+    {
+        return;
+    }
+
+    EnsureTextures(RHICmdList, Frame);
+
+    // Upload each plane straight from the mapped buffer, honoring the decoder's row pitch
+    FRHITexture* Planes[3] = { LumaTexture, ChromaTexture, ChromaVTexture };
+    for (int32 Index = 0; Index < Frame.NumPlanes; ++Index)
+    {
+        const FIntPoint Size = PlaneSize(Frame, Index);
+        const FUpdateTextureRegion2D Region(0, 0, 0, 0, Size.X, Size.Y);
+        RHICmdList.UpdateTexture2D(Planes[Index], 0, Region, Frame.PlaneStrides[Index], Frame.Sample.GetData() + Frame.PlaneOffsets[Index]);
+    }
+
+    // Draw straight into the display target, every pixel is written
+    RHICmdList.Transition(FRHITransitionInfo(Destination, ERHIAccess::Unknown, ERHIAccess::RTV));
+
+    FRHIRenderPassInfo RPInfo(Destination, ERenderTargetActions::DontLoad_Store);
+    RHICmdList.BeginRenderPass(RPInfo, TEXT("GStreamer YUV to RGB"));
+    {
+        FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+        TShaderMapRef<FGStreamerFullscreenVS> VertexShader(ShaderMap);
+
+        FGStreamerYUVToRGBPS::FPermutationDomain Permutation;
+        Permutation.Set<FGStreamerYUVToRGBPS::FPlanarChroma>(Frame.Format == EGStreamerPixelFormat::I420);
+        Permutation.Set<FGStreamerYUVToRGBPS::FLinearOutput>(EnumHasAnyFlags(Destination->GetFlags(), ETextureCreateFlags::SRGB));
+        TShaderMapRef<FGStreamerYUVToRGBPS> PixelShader(ShaderMap, Permutation);
+
+        FGraphicsPipelineStateInitializer GraphicsPSOInit;
+        RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+        GraphicsPSOInit.DepthStencilState = TStaticDepthStencilState<false, CF_Always>::GetRHI();
+        GraphicsPSOInit.RasterizerState = TStaticRasterizerState<>::GetRHI();
+        GraphicsPSOInit.BlendState = TStaticBlendState<>::GetRHI();
+        GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GEmptyVertexDeclaration.VertexDeclarationRHI;
+        GraphicsPSOInit.BoundShaderState.VertexShaderRHI = VertexShader.GetVertexShader();
+        GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
+        GraphicsPSOInit.PrimitiveType = PT_TriangleList;
+        SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit, 0);
+
+        FGStreamerYUVToRGBPS::FParameters Parameters;
+        Parameters.LumaTexture = LumaTexture;
+        Parameters.ChromaTexture = ChromaTexture;
+        Parameters.ChromaVTexture = ChromaVTexture.IsValid() ? ChromaVTexture : ChromaTexture;
+        Parameters.LumaSampler = TStaticSamplerState<SF_Point>::GetRHI();
+        Parameters.ChromaSampler = TStaticSamplerState<SF_Bilinear>::GetRHI();
+        SetShaderParameters(RHICmdList, PixelShader, PixelShader.GetPixelShader(), Parameters);
+
+        RHICmdList.SetViewport(0, 0, 0.0f, Frame.Width, Frame.Height, 1.0f);
+        RHICmdList.DrawPrimitive(0, 1, 1);
+    }
+    RHICmdList.EndRenderPass();
+
+    RHICmdList.Transition(FRHITransitionInfo(Destination, ERHIAccess::RTV, ERHIAccess::SRVMask));
+}
@@ -37,4 +37,16 @@ struct GSTREAMERPLUGIN_API FGStreamerStats
     int64 SRTPacketsLost = 0;
     UPROPERTY(BlueprintReadOnly, Category = "GStreamer Stats")
     double SRTRoundTripMs = 0.0;
+
+    // Decoded frames dropped because every frame pool slot was in use
+    UPROPERTY(BlueprintReadOnly, Category = "GStreamer Stats")
+    int64 FramePoolExhausted = 0;
+
+    // Decoded frames replaced by a newer one before they could be displayed
+    UPROPERTY(BlueprintReadOnly, Category = "GStreamer Stats")
+    int64 FramesSuperseded = 0;
+
+    // Frames dropped because the render thread was still busy with earlier uploads
+    UPROPERTY(BlueprintReadOnly, Category = "GStreamer Stats")
+    int64 FramesSkippedUploading = 0;
 };
\ No newline at end of file
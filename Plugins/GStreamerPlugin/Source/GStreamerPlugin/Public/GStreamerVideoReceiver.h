@@ -1,11 +1,10 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
 #include "GStreamerStats.h"
 #include "HAL/Runnable.h"
 #include "HAL/RunnableThread.h"
-#include "Containers/Queue.h"
 
 // Forward declarations for GStreamer C API
 extern "C" void* GStreamerGetBus(void* pipeline);
@@ -28,18 +27,108 @@ extern "C" void* GStreamerGetSampleCaps(void* sample);
 extern "C" bool GStreamerGetVideoDimensions(void* caps, int* width, int* height);
 extern "C" bool GStreamerCopyBufferData(void* buffer, unsigned char* dest, int size);
 extern "C" int GStreamerGetBufferSize(void* buffer);
+extern "C" void* GStreamerMapSample(void* sample, const unsigned char** data, int* size);
+extern "C" void GStreamerUnmapSample(void* mapped_sample);
+extern "C" bool GStreamerGetSampleLayout(void* sample, int* format, int* num_planes, int* offsets, int* strides);
 extern "C" void GStreamerFreeSample(void* sample);
 extern "C" void GStreamerUnrefElement(void* element);
 
+class FGStreamerYUVConverter;
+
+/**
+ * A decoded GstSample whose buffer stays mapped until it is reset.
+ * Lets the image be uploaded to the GPU straight from GStreamer's memory.
+ */
+class FGStreamerMappedSample
+{
+public:
+    FGStreamerMappedSample() = default;
+    ~FGStreamerMappedSample() { Reset(); }
+
+    FGStreamerMappedSample(const FGStreamerMappedSample&) = delete;
+    FGStreamerMappedSample& operator=(const FGStreamerMappedSample&) = delete;
+
+    /** Map Sample's buffer, releasing any previous one. Takes its own sample reference. */
+    bool Map(void* Sample);
+
+    /** Unmap and release the sample, which hands its buffer back to the decoder */
+    void Reset();
+
+    const uint8* GetData() const { return Data; }
+    int32 GetSize() const { return Size; }
+
+private:
+    void* Handle = nullptr;
+    const uint8* Data = nullptr;
+    int32 Size = 0;
+};
+
+/** Pixel layout of a decoded frame, as reported by GStreamerGetSampleLayout */
+enum class EGStreamerPixelFormat : int32
+{
+    Unknown = 0,
+    RGBA = 1,   // RGBA or BGRA, one packed plane, uploaded as is
+    NV12 = 2,   // Y plane, then interleaved half-size CbCr plane
+    I420 = 3    // Y plane, then half-size Cb and Cr planes
+};
+
 /**
- * Represents a single decoded video frame
+ * Represents a single decoded video frame.
+ * Holds a reference to the decoder's buffer rather than a copy of the pixels.
  */
 struct FVideoFrame
 {
-    TArray<uint8> Data;
+    FGStreamerMappedSample Sample;
     int32 Width = 0;
     int32 Height = 0;
     double Timestamp = 0.0;
+
+    // Plane layout within the mapped buffer
+    EGStreamerPixelFormat Format = EGStreamerPixelFormat::Unknown;
+    int32 NumPlanes = 0;
+    int32 PlaneOffsets[3] = {};
+    int32 PlaneStrides[3] = {};
+};
+
+/**
+ * Fixed set of frame slots passed between the pull thread, the game thread and the
+ * render thread, so nothing is allocated per frame. A slot is acquired and filled
+ * when a sample is pulled, published as the latest frame, taken by the game thread
+ * and released once its upload completes. This also bounds how many decoded buffers
+ * are held outside GStreamer, so the decoder's buffer pool never has to grow.
+ */
+class FVideoFramePool
+{
+public:
+    /** One being filled, one published, up to two uploading, one spare */
+    static constexpr int32 NumSlots = 5;
+
+    /** A free slot, or null (counted) if every slot is in use. Any thread. */
+    FVideoFrame* Acquire();
+
+    /** Make Frame the latest frame. An older frame nobody took is released and counted. */
+    void Publish(FVideoFrame* Frame);
+
+    /** The latest frame if one was published since the last call, else null. Caller releases it. */
+    FVideoFrame* TakeLatest();
+
+    bool HasLatest() const { return Latest.Load() != INDEX_NONE; }
+
+    /** Release the frame's sample and return its slot. Any thread. */
+    void Release(FVideoFrame* Frame);
+
+    /** Frames dropped on arrival because every slot was in use */
+    uint32 GetExhaustedCount() const { return ExhaustedCount.Load(); }
+
+    /** Frames replaced by a newer one before the game thread took them */
+    uint32 GetSupersededCount() const { return SupersededCount.Load(); }
+
+private:
+    FVideoFrame Slots[NumSlots];
+    TAtomic<uint32> FreeMask{ (1u << NumSlots) - 1 };
+    TAtomic<int32> Latest{ INDEX_NONE };
+    TAtomic<uint32> ExhaustedCount{ 0 };
+    TAtomic<uint32> SupersededCount{ 0 };
 };
 
 /**
@@ -49,8 +138,9 @@ struct FVideoFrame
 class FFramePullRunnable : public FRunnable
 {
 public:
-    FFramePullRunnable(void* InAppSink) 
+    FFramePullRunnable(void* InAppSink, FVideoFramePool& InFramePool) 
         : AppSink(InAppSink)
+        , FramePool(InFramePool)
         , bShouldStop(false) 
     {}
     
@@ -64,18 +154,17 @@ public:
     
     /**
      * Try to get the latest frame (non-blocking)
-     * @param OutFrame - Will be filled with frame data if available
-     * @return true if a frame was available
+     * @return the frame, to be released to the pool once uploaded, or null if none arrived
      */
-    bool PopFrame(FVideoFrame& OutFrame);
+    FVideoFrame* PopFrame() { return FramePool.TakeLatest(); }
     
     /** Check if the thread has any frames waiting */
-    bool HasPendingFrame() const { return !FrameQueue.IsEmpty(); }
+    bool HasPendingFrame() const { return FramePool.HasLatest(); }
     
 private:
     void* AppSink;
+    FVideoFramePool& FramePool;
     TAtomic<bool> bShouldStop;
-    TQueue<FVideoFrame, EQueueMode::Spsc> FrameQueue;  // Single-producer single-consumer for best performance
 };
 
 /**
@@ -91,7 +180,8 @@ public:
     bool Initialize(int32 Port = 5004, int SRTLatencyMs=200, bool bUseHardwareDecoder = false);
     bool Start();
     void Stop();
-    bool UpdateTexture(UTexture2D* Texture);
+    /** Upload the latest frame into Target, resizing it to the frame if needed. Game thread. */
+    bool UpdateTexture(UTextureRenderTarget2D* Target);
     void GetDimensions(int32& OutWidth, int32& OutHeight) const;
     FGStreamerStats GetStatistics();
     bool IsUsingHardwareDecoder() const { return bUsingHardwareDecoder; }
@@ -113,9 +203,19 @@ private:
     double LastFPSUpdateTime;
     int32 CurrentFPS;
     
+    // Frame slots, filled by the pull thread (or the game thread) and released after upload
+    FVideoFramePool FramePool;
+
+    // Draws YUV frames as RGBA into the target. Render thread only.
+    TUniquePtr<FGStreamerYUVConverter> YUVConverter;
+
     // Background frame pulling (for hardware decode)
     TUniquePtr<FFramePullRunnable> FramePullRunnable;
     TUniquePtr<FRunnableThread> FramePullThread;
     bool bUseBackgroundThread;
-    TAtomic<bool> bUpdateInFlight{ false };
+
+    // Uploads queued on the render thread that still hold a frame slot
+    static constexpr int32 MaxUploadsInFlight = 2;
+    TAtomic<int32> UploadsInFlight{ 0 };
+    uint32 UploadsSkipped = 0;
 };
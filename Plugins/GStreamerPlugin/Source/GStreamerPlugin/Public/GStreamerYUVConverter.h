@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "RHIResources.h"
+
+struct FVideoFrame;
+class FRHICommandListImmediate;
+
+/**
+ * Uploads the planes of a YUV frame (1.5 bytes per pixel) and converts them to RGBA
+ * with a pixel shader, instead of running videoconvert to RGBA on the CPU and
+ * uploading 4 bytes per pixel. All methods run on the render thread.
+ */
+class GSTREAMERPLUGIN_API FGStreamerYUVConverter
+{
+public:
+    /** True for the formats Convert accepts */
+    static bool SupportsFormat(const FVideoFrame& Frame);
+
+    /** True if every plane of Frame lies within its mapped buffer */
+    static bool HasCompletePlanes(const FVideoFrame& Frame);
+
+    /**
+     * Convert Frame into Destination, a render-targetable texture of the frame's size.
+     * Plane textures are reallocated only when the frame size or format changes.
+     */
+    void Convert(FRHICommandListImmediate& RHICmdList, const FVideoFrame& Frame, FRHITexture* Destination);
+
+private:
+    void EnsureTextures(FRHICommandListImmediate& RHICmdList, const FVideoFrame& Frame);
+
+    FTextureRHIRef LumaTexture;
+    FTextureRHIRef ChromaTexture;
+    FTextureRHIRef ChromaVTexture;
+
+    FIntPoint TextureSize = FIntPoint::ZeroValue;
+    int32 TextureFormat = 0;
+};
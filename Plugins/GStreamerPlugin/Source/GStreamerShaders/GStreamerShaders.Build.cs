@@ -0,0 +1,21 @@
+using UnrealBuildTool;
+
+public class GStreamerShaders : ModuleRules
+{
+    public GStreamerShaders(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(new string[]
+        {
+            "Core",
+            "RenderCore",
+            "RHI"
+        });
+
+        PrivateDependencyModuleNames.AddRange(new string[]
+        {
+            "Projects"
+        });
+    }
+}
@@ -0,0 +1,26 @@
+#include "GStreamerShaders.h"
+#include "Modules/ModuleManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+#include "ShaderCore.h"
+
+IMPLEMENT_GLOBAL_SHADER(FGStreamerFullscreenVS, "/Plugin/GStreamerPlugin/Private/GStreamerYUV.usf", "GStreamerFullscreenVS", SF_Vertex);
+IMPLEMENT_GLOBAL_SHADER(FGStreamerYUVToRGBPS, "/Plugin/GStreamerPlugin/Private/GStreamerYUV.usf", "GStreamerYUVToRGBPS", SF_Pixel);
+
+// Shader types must be registered before the global shader map loads, which is why these
+// live in their own module loaded at PostConfigInit rather than in GStreamerPlugin
+class FGStreamerShadersModule : public IModuleInterface
+{
+public:
+    virtual void StartupModule() override
+    {
+        const FString ShaderDir = FPaths::Combine(IPluginManager::Get().FindPlugin(TEXT("GStreamerPlugin"))->GetBaseDir(), TEXT("Shaders"));
+        AddShaderSourceDirectoryMapping(TEXT("/Plugin/GStreamerPlugin"), ShaderDir);
+    }
+
+    virtual void ShutdownModule() override
+    {
+    }
+};
+
+IMPLEMENT_MODULE(FGStreamerShadersModule, GStreamerShaders)
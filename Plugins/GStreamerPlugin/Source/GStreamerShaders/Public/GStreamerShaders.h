@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+#include "DataDrivenShaderPlatformInfo.h"
+
+/**
+ * Full-screen triangle generated from the vertex id, so no vertex buffer is needed.
+ * Use with GEmptyVertexDeclaration and DrawPrimitive(0, 1, 1).
+ */
+class FGStreamerFullscreenVS : public FGlobalShader
+{
+    DECLARE_EXPORTED_GLOBAL_SHADER(FGStreamerFullscreenVS, GSTREAMERSHADERS_API);
+
+public:
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::ES3_1);
+    }
+
+    FGStreamerFullscreenVS() {}
+
+    FGStreamerFullscreenVS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+        : FGlobalShader(Initializer)
+    {}
+};
+
+/**
+ * Converts decoded 4:2:0 video planes to RGBA: a full-size luma plane plus either one
+ * interleaved CbCr plane (NV12) or separate Cb and Cr planes (I420, PLANAR_CHROMA).
+ * Output is BT.709 limited range expanded to full range, still gamma encoded.
+ */
+class FGStreamerYUVToRGBPS : public FGlobalShader
+{
+    DECLARE_EXPORTED_GLOBAL_SHADER(FGStreamerYUVToRGBPS, GSTREAMERSHADERS_API);
+    SHADER_USE_PARAMETER_STRUCT(FGStreamerYUVToRGBPS, FGlobalShader);
+
+public:
+    class FPlanarChroma : SHADER_PERMUTATION_BOOL("PLANAR_CHROMA");
+    class FLinearOutput : SHADER_PERMUTATION_BOOL("LINEAR_OUTPUT");     // target encodes to sRGB on write
+    using FPermutationDomain = TShaderPermutationDomain<FPlanarChroma, FLinearOutput>;
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_TEXTURE(Texture2D, LumaTexture)
+        SHADER_PARAMETER_TEXTURE(Texture2D, ChromaTexture)     // CbCr (NV12) or Cb (I420)
+        SHADER_PARAMETER_TEXTURE(Texture2D, ChromaVTexture)    // Cr (I420 only)
+        SHADER_PARAMETER_SAMPLER(SamplerState, LumaSampler)
+        SHADER_PARAMETER_SAMPLER(SamplerState, ChromaSampler)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::ES3_1);
+    }
+};
@@ -0,0 +1,73 @@
+#include "ClockSync.h"
+
+bool FClockSync::AddSample(uint64 T0, uint64 T1, uint64 T2, uint64 T3)
+{
+	// Differences are taken in uint64 and reinterpreted, so clocks with unrelated epochs work
+	const int64 Outbound = static_cast<int64>(T1 - T0);
+	const int64 Inbound = static_cast<int64>(T2 - T3);
+	const int64 Delay = static_cast<int64>(T3 - T0) - static_cast<int64>(T2 - T1);
+	if (Delay < 0 || T3 < T0) return false;
+
+	FSample& Sample = Window[WindowNext];
+	Sample.LocalTime = T3;
+	Sample.OffsetNs = Outbound / 2 + Inbound / 2;
+	Sample.DelayNs = Delay;
+	WindowNext = (WindowNext + 1) % WindowSize;
+	WindowCount = FMath::Min(WindowCount + 1, WindowSize);
+	LastDelayNs = Delay;
+	++NumSamples;
+
+	// Min-filter: lowest round trip in the window carries the least queuing error
+	const FSample* Lowest = &Window[0];
+	for (int32 i = 1; i < WindowCount; ++i)
+	{
+		if (Window[i].DelayNs < Lowest->DelayNs) Lowest = &Window[i];
+	}
+
+	if (Lowest->LocalTime != Best.LocalTime || NumSamples == 1)
+	{
+		Best = *Lowest;
+		BestDelayNs = Lowest->DelayNs;
+		UpdateDrift();
+	}
+	return true;
+}
+
+void FClockSync::UpdateDrift()
+{
+	DriftHistory[DriftNext] = Best;
+	DriftNext = (DriftNext + 1) % DriftHistorySize;
+	DriftCount = FMath::Min(DriftCount + 1, DriftHistorySize);
+
+	const FSample& Oldest = DriftHistory[DriftCount < DriftHistorySize ? 0 : DriftNext];
+	const double SpanSeconds = static_cast<int64>(Best.LocalTime - Oldest.LocalTime) / 1e9;
+	if (DriftCount < 3 || SpanSeconds < MinDriftSpanSeconds) return;
+
+	// Least-squares slope of offset over time, relative to the oldest point to keep precision
+	double SumX = 0, SumY = 0, SumXX = 0, SumXY = 0;
+	for (int32 i = 0; i < DriftCount; ++i)
+	{
+		const double X = static_cast<int64>(DriftHistory[i].LocalTime - Oldest.LocalTime) / 1e9;
+		const double Y = static_cast<double>(DriftHistory[i].OffsetNs - Oldest.OffsetNs);
+		SumX += X; SumY += Y; SumXX += X * X; SumXY += X * Y;
+	}
+
+	const double Denom = DriftCount * SumXX - SumX * SumX;
+	if (FMath::Abs(Denom) < UE_SMALL_NUMBER) return;
+
+	// ns per second -> parts per million
+	DriftPpm = (DriftCount * SumXY - SumX * SumY) / Denom / 1e3;
+}
+
+int64 FClockSync::GetOffsetNs(uint64 LocalNs) const
+{
+	if (NumSamples == 0) return 0;
+
+	const double Elapsed = static_cast<double>(static_cast<int64>(LocalNs - Best.LocalTime));
+	return Best.OffsetNs + static_cast<int64>(DriftPpm * 1e-6 * Elapsed);
+}
+
+void FClockSync::Reset()
+{
+	*this = FClockSync();
+}
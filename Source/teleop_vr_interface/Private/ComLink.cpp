@@ -1,5 +1,7 @@
 #include "ComLink.h"
 #include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
 
 UComLink::UComLink()
 {
@@ -15,13 +17,158 @@ void UComLink::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Create UDP socket  send and receive on the same socket
-	Socket = MakeUnique<udpClient>(RemoteIP, true, SendPort, true, ReceivePort);
+	if (!ReplayFile.IsEmpty())
+	{
+		// Recorded session in place of the robot; everything above the transport runs unchanged
+		FReplayTransport::FConfig ReplayConfig;
+		ReplayConfig.FilePath = ReplayFile;
+		ReplayConfig.Speed = ReplaySpeed;
+		ReplayConfig.bLoop = bReplayLoop;
+		ReplayConfig.bWaitForConsumer = bReplayWaitForConsumer;
+
+		TUniquePtr<FReplayTransport> ReplayTransport = MakeUnique<FReplayTransport>(ReplayConfig);
+		Replay = ReplayTransport.Get();
+		Socket = MoveTemp(ReplayTransport);
+	}
+	else if (RemoteIP.StartsWith(SharedMemoryPrefix))
+	{
+		// Simulator on this machine: exchange datagrams through shared memory instead of UDP loopback
+		Socket = MakeUnique<FSharedMemoryTransport>(RemoteIP.RightChop(FCString::Strlen(SharedMemoryPrefix)), static_cast<SIZE_T>(FMath::Clamp(SharedMemoryRingKB, 64, 1024 * 1024)) * 1024);
+	}
+	else
+	{
+		FUdpSocketOptions SocketOptions;
+		SocketOptions.Dscp = Dscp;
+		SocketOptions.SocketPriority = SocketPriority;
+		SocketOptions.MulticastGroup = MulticastGroup;
+		SocketOptions.MulticastInterface = MulticastInterface;
+		SocketOptions.MulticastTtl = MulticastTtl;
+
+		// One socket serves every endpoint, so a single IPv6 address anywhere needs a dual-stack socket
+		SocketOptions.bIPv6 = bUseIPv6 || Endpoints.ContainsByPredicate([](const FComLinkEndpoint& Endpoint)
+		{
+			return Endpoint.RemoteIP.Contains(TEXT(":"));
+		});
+
+		// Create UDP socket  send and receive on the same socket
+		Socket = MakeUnique<udpClient>(RemoteIP, true, SendPort, true, ReceivePort, SocketOptions);
+	}
 
 	if (Socket)
 	{
-		UE_LOG(LogTemp, Log, TEXT("ComLink: Initialized  send to %s:%d, receive on :%d"),
-			*RemoteIP, SendPort, ReceivePort);
+		if (!IsValidEndpoint(ArmEndpoint) || !IsValidEndpoint(CameraEndpoint))
+		{
+			UE_LOG(LogTemp, Error, TEXT("ComLink: Arm endpoint %d / camera endpoint %d out of range, using the primary"),
+				ArmEndpoint, CameraEndpoint);
+			ArmEndpoint = IsValidEndpoint(ArmEndpoint) ? ArmEndpoint : 0;
+			CameraEndpoint = IsValidEndpoint(CameraEndpoint) ? CameraEndpoint : 0;
+		}
+		KnownEndpoints |= (1u << ArmEndpoint) | (1u << CameraEndpoint);
+		TelemetryEndpoint = static_cast<uint8>(ArmEndpoint);
+
+		for (const FComLinkEndpoint& Endpoint : Endpoints)
+		{
+			if (Endpoint.Id <= 0 || !IsValidEndpoint(Endpoint.Id))
+			{
+				UE_LOG(LogTemp, Error, TEXT("ComLink: Endpoint '%s' has invalid ID %d (1-%d), ignored"),
+					*Endpoint.Name, Endpoint.Id, MaxEndpoints - 1);
+				continue;
+			}
+
+			// Without an address of its own it shares the primary's, e.g. a gateway serving several robots
+			if (!Endpoint.RemoteIP.IsEmpty() || Endpoint.SendPort > 0)
+			{
+				Socket->set_endpoint_address(static_cast<uint8>(Endpoint.Id),
+					Endpoint.RemoteIP.IsEmpty() ? RemoteIP : Endpoint.RemoteIP,
+					Endpoint.SendPort > 0 ? Endpoint.SendPort : SendPort);
+			}
+			KnownEndpoints |= 1u << Endpoint.Id;
+			UE_LOG(LogTemp, Log, TEXT("ComLink: Endpoint %d '%s'"), Endpoint.Id, *Endpoint.Name);
+		}
+
+		// Robot states fan out to telemetry subscribers straight from the receive thread
+		FRobotStateTelemetry* TelemetryHub = EnsureTelemetry();
+		Socket->set_receive_observer([this, TelemetryHub](uint8 Endpoint, uint8 MsgType, const uint8* Data, int32 Size, double ReceiveTime)
+		{
+			if (Replay && Replay->GetLoopCount() != TelemetryReplayLoops)
+			{
+				TelemetryReplayLoops = Replay->GetLoopCount();
+				TelemetryHub->RestartSequences();
+			}
+			if (Endpoint == TelemetryEndpoint.Load(EMemoryOrder::Relaxed))
+			{
+				TelemetryHub->OnPacket(MsgType, Data, Size, ReceiveTime);
+			}
+		});
+
+		if (bRecordSession && !Replay)
+		{
+			const FString Directory = RecordingDirectory.IsEmpty()
+				? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ComLinkSessions"))
+				: RecordingDirectory;
+			const FString FilePath = FPaths::Combine(Directory,
+				FString::Printf(TEXT("ComLink_%s.tlrec"), *FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S"))));
+
+			Recorder = MakeUnique<FSessionRecorder>(FilePath, RecordingBufferKB * 1024);
+			if (Recorder->IsRecording())
+			{
+				Socket->set_recorder(Recorder.Get());
+			}
+			else
+			{
+				Recorder.Reset();
+			}
+		}
+
+		if (StatusQueueCapacity > 0)
+		{
+			Socket->enable_queue(static_cast<uint8>(EMsgType::SystemStatus), StatusQueueCapacity);
+		}
+
+		// Every ack settles a command and carries an RTT sample, every pong a clock sample;
+		// ProcessIncoming visits each queued packet in arrival order
+		const int32 ReplyCapacity = FMath::Max(ReplyQueueCapacity, 1);
+		Socket->enable_queue(static_cast<uint8>(EMsgType::CommandAck), ReplyCapacity);
+		Socket->enable_queue(static_cast<uint8>(EMsgType::TimeSyncPong), ReplyCapacity);
+
+		Commands.InitialTimeout = CommandRetryTimeout;
+		Commands.MaxAttempts = CommandMaxAttempts;
+		Commands.OnResult = [this](uint8 Endpoint, uint8 MsgType, uint32 Sequence, ECommandResult Result, float LatencyMs)
+		{
+			OnCommandResult.Broadcast(Endpoint, static_cast<EMsgType>(MsgType), Sequence, Result, LatencyMs);
+		};
+
+		if (PoseSendRateHz > 0.0f)
+		{
+			// The per-stream caps still apply to the sender thread's cycles
+			auto WarnIfCapped = [this](const TCHAR* Stream, const FPoseStreamSendConfig& Config)
+			{
+				if (Config.MaxRateHz > 0.0f && Config.MaxRateHz < PoseSendRateHz)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("ComLink: %s poses are capped at %.0f Hz, below PoseSendRateHz %.0f Hz"),
+						Stream, Config.MaxRateHz, PoseSendRateHz);
+				}
+			};
+			WarnIfCapped(TEXT("Head"), HeadSendConfig);
+			WarnIfCapped(TEXT("Hand"), HandSendConfig);
+
+			PoseSender = MakeUnique<FFixedRateThread>(TEXT("ComLinkPoseSender"), PoseSendRateHz,
+				[this]() { RunPoseSendCycle(); });
+		}
+
+		if (Replay)
+		{
+			UE_LOG(LogTemp, Log, TEXT("ComLink: Initialized  replaying %s"), *ReplayFile);
+		}
+		else if (RemoteIP.StartsWith(SharedMemoryPrefix))
+		{
+			UE_LOG(LogTemp, Log, TEXT("ComLink: Initialized  shared memory %s"), *RemoteIP);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("ComLink: Initialized  send to %s:%d, receive on :%d"),
+				*RemoteIP, SendPort, ReceivePort);
+		}
 	}
 	else
 	{
@@ -31,12 +178,21 @@ void UComLink::BeginPlay()
 
 void UComLink::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	// The sender thread uses the socket, so it goes first
+	PoseSender.Reset();
+	Commands.Cancel();
+
 	if (Socket)
 	{
 		Socket->stop();
 		Socket.Reset();
+		Replay = nullptr;
 	}
 
+	// After the socket: the receive thread feeds the telemetry hub and all socket threads record
+	Telemetry.Reset();
+	Recorder.Reset();
+
 	UE_LOG(LogTemp, Log, TEXT("ComLink: Stopped"));
 	Super::EndPlay(EndPlayReason);
 }
@@ -44,7 +200,35 @@ void UComLink::EndPlay(const EEndPlayReason::Type EndPlayReason)
 void UComLink::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Poses queued last frame by a caller that did not flush
+	FlushSends();
 	ProcessIncoming();
+
+	// After ProcessIncoming, so acknowledgements that already arrived are not retransmitted
+	if (Socket)
+	{
+		Commands.Tick(FPlatformTime::Seconds(), [this](const uint8* Data, int32 Size)
+		{
+			return Socket->send_raw(Data, Size);
+		});
+	}
+
+	if (Socket && TimeSyncInterval > 0.0f)
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (LastPingTime < 0.0 || Now - LastPingTime >= TimeSyncInterval)
+		{
+			LastPingTime = Now;
+			for (int32 Endpoint = 0; Endpoint < MaxEndpoints; ++Endpoint)
+			{
+				if (KnownEndpoints & (1u << Endpoint))
+				{
+					SendTimeSyncPing(static_cast<uint8>(Endpoint));
+				}
+			}
+		}
+	}
 }
 
 // ============================================================================
@@ -54,47 +238,293 @@ void UComLink::TickComponent(float DeltaTime, ELevelTick TickType, FActorCompone
 void UComLink::SendHeadPose(const FTrackedPose& Pose)
 {
 	if (!Socket || !Pose.bIsValid) return;
+	SubmitPose(EMsgType::HeadPose, Pose, 0.0f);
+}
+
+void UComLink::SendHandPose(const FTrackedPose& Pose, float TriggerValue, bool bIsLeft)
+{
+	if (!Socket || !Pose.bIsValid) return;
+	SubmitPose(bIsLeft ? EMsgType::HandLeft : EMsgType::HandRight, Pose, TriggerValue);
+}
 
-	FWirePose Wire;
+uint32 UComLink::SendModeCommand(EOpMode Mode, FOnCommandComplete OnComplete)
+{
+	return SendModeCommandTo(static_cast<uint8>(ArmEndpoint), Mode, MoveTemp(OnComplete));
+}
+
+uint32 UComLink::SendModeCommandTo(uint8 Endpoint, EOpMode Mode, FOnCommandComplete OnComplete)
+{
+	if (!Socket || !IsValidEndpoint(Endpoint)) return 0;
+
+	FWireModeCommand Wire;
 	Wire.Timestamp = static_cast<uint64>(FPlatformTime::Seconds() * 1e9);
-	Wire.Sequence = NextSequence();
-	Wire.Type = static_cast<uint8>(EMsgType::HeadPose);
+	Wire.Sequence = NextSequence(Endpoint, EMsgType::ModeCommand);
+	Wire.Mode = static_cast<uint8>(Mode);
 
-	CoordConvert::UnrealToProtocol(Pose.Position, Wire.PX, Wire.PY, Wire.PZ);
-	CoordConvert::UnrealToProtocolQuat(Pose.Orientation, Wire.QX, Wire.QY, Wire.QZ, Wire.QW);
+	// Mode changes go out immediately instead of waiting for the next pose flush
+	if (UseCompactEncoding())
+	{
+		FWireModeCommand::FCompactBuffer Buf;
+		Wire.PackCompact(Buf);
+		return SendReliable(Endpoint, EMsgType::ModeCommand, Wire.Sequence, 0, Buf.GetData(), Buf.Num(), MoveTemp(OnComplete));
+	}
 
-	msgpack::sbuffer buf = Wire.Pack();
-	Socket->send_raw(reinterpret_cast<const uint8*>(buf.data()), buf.size());
+	FWireModeCommand::FPackBuffer Buf;
+	Wire.Pack(Buf);
+	return SendReliable(Endpoint, EMsgType::ModeCommand, Wire.Sequence, 0, Buf.GetData(), Buf.Num(), MoveTemp(OnComplete));
 }
 
-void UComLink::SendHandPose(const FTrackedPose& Pose, float TriggerValue, bool bIsLeft)
+uint32 UComLink::SendConfigUpdate(uint16 Key, float Value, FOnCommandComplete OnComplete)
 {
-	if (!Socket || !Pose.bIsValid) return;
+	return SendConfigUpdateTo(static_cast<uint8>(ArmEndpoint), Key, Value, MoveTemp(OnComplete));
+}
 
-	FWirePose Wire;
+uint32 UComLink::SendConfigUpdateTo(uint8 Endpoint, uint16 Key, float Value, FOnCommandComplete OnComplete)
+{
+	if (!Socket || !IsValidEndpoint(Endpoint)) return 0;
+
+	FWireConfigUpdate Wire;
 	Wire.Timestamp = static_cast<uint64>(FPlatformTime::Seconds() * 1e9);
-	Wire.Sequence = NextSequence();
-	Wire.Type = static_cast<uint8>(bIsLeft ? EMsgType::HandLeft : EMsgType::HandRight);
-	Wire.TriggerValue = static_cast<double>(TriggerValue);
+	Wire.Sequence = NextSequence(Endpoint, EMsgType::ConfigUpdate);
+	Wire.Key = Key;
+	Wire.Value = static_cast<double>(Value);
+
+	if (UseCompactEncoding())
+	{
+		FWireConfigUpdate::FCompactBuffer Buf;
+		Wire.PackCompact(Buf);
+		return SendReliable(Endpoint, EMsgType::ConfigUpdate, Wire.Sequence, Key, Buf.GetData(), Buf.Num(), MoveTemp(OnComplete));
+	}
 
-	CoordConvert::UnrealToProtocol(Pose.Position, Wire.PX, Wire.PY, Wire.PZ);
-	CoordConvert::UnrealToProtocolQuat(Pose.Orientation, Wire.QX, Wire.QY, Wire.QZ, Wire.QW);
+	FWireConfigUpdate::FPackBuffer Buf;
+	Wire.Pack(Buf);
+	return SendReliable(Endpoint, EMsgType::ConfigUpdate, Wire.Sequence, Key, Buf.GetData(), Buf.Num(), MoveTemp(OnComplete));
+}
 
-	msgpack::sbuffer buf = Wire.Pack();
-	Socket->send_raw(reinterpret_cast<const uint8*>(buf.data()), buf.size());
+uint32 UComLink::SendReliable(uint8 Endpoint, EMsgType Type, uint32 Sequence, uint32 SupersedeKey, const uint8* Data, int32 Size,
+	FOnCommandComplete OnComplete)
+{
+	// Retransmissions reuse the same bytes, envelope included, and sequence, so the remote can discard repeats
+	EmitTo(Endpoint, Data, Size, [this, Endpoint, Type, Sequence, SupersedeKey, &OnComplete](const uint8* Enveloped, int32 EnvelopedSize)
+	{
+		Commands.Submit(Endpoint, static_cast<uint8>(Type), Sequence, SupersedeKey, Enveloped, EnvelopedSize, MoveTemp(OnComplete),
+			FPlatformTime::Seconds(), [this](const uint8* InData, int32 InSize)
+			{
+				return Socket->send_raw(InData, InSize);
+			});
+	});
+	return Sequence;
 }
 
-void UComLink::SendModeCommand(EOpMode Mode)
+void UComLink::SetArmEndpoint(int32 Endpoint)
 {
-	if (!Socket) return;
+	if (!IsValidEndpoint(Endpoint))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ComLink: Arm endpoint %d out of range"), Endpoint);
+		return;
+	}
+	ArmEndpoint = Endpoint;
+	TelemetryEndpoint = static_cast<uint8>(Endpoint);
+	KnownEndpoints |= 1u << Endpoint;
+}
 
-	FWireModeCommand Wire;
-	Wire.Timestamp = static_cast<uint64>(FPlatformTime::Seconds() * 1e9);
-	Wire.Sequence = NextSequence();
-	Wire.Mode = static_cast<uint8>(Mode);
+void UComLink::SetCameraEndpoint(int32 Endpoint)
+{
+	if (!IsValidEndpoint(Endpoint))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ComLink: Camera endpoint %d out of range"), Endpoint);
+		return;
+	}
+	CameraEndpoint = Endpoint;
+	KnownEndpoints |= 1u << Endpoint;
+}
+
+void UComLink::EmitTo(uint8 Endpoint, const uint8* Data, int32 Size, TFunctionRef<void(const uint8*, int32)> Emit)
+{
+	if (Endpoint == 0)
+	{
+		Emit(Data, Size);
+		return;
+	}
+
+	TArray<uint8, TInlineAllocator<256>> Enveloped;
+	Enveloped.Add(EndpointWire::Tag);
+	Enveloped.Add(Endpoint);
+	Enveloped.Append(Data, Size);
+	Emit(Enveloped.GetData(), Enveloped.Num());
+}
+
+bool UComLink::ShouldSendPose(EMsgType Type, uint8 Endpoint, const FTrackedPose& Pose, float TriggerValue)
+{
+	const bool bIsHead = (Type == EMsgType::HeadPose);
+	const FPoseStreamSendConfig& Config = bIsHead ? HeadSendConfig : HandSendConfig;
+	FPoseSendState& State = PoseSendStates[PoseStreamIndex(Type)];
+	const double Now = FPlatformTime::Seconds();
+
+	// Deadline-based limiter: frame-time jitter around the target rate does not cost sends
+	if (Config.MaxRateHz > 0.0f && Now < State.NextSendTime)
+	{
+		++PosesRateLimited;
+		return false;
+	}
+
+	// Dedup is on when either threshold is set; KeepAliveInterval only bounds how long a skip lasts.
+	// A stream switched to another endpoint always sends, the new one has not seen the pose yet.
+	const bool bDedup = Config.PositionThreshold > 0.0f || Config.AngleThresholdDeg > 0.0f;
+	const bool bKeepAliveDue = Config.KeepAliveInterval > 0.0f && Now - State.LastSendTime >= Config.KeepAliveInterval;
+	if (bDedup && State.LastSendTime >= 0.0 && State.LastEndpoint == Endpoint && !bKeepAliveDue)
+	{
+		const bool bMoved = FVector::Dist(Pose.Position, State.LastPose.Position) > Config.PositionThreshold;
+		const bool bTurned = FMath::RadiansToDegrees(
+			Pose.Orientation.Quaternion().AngularDistance(State.LastPose.Orientation.Quaternion())) > Config.AngleThresholdDeg;
+		const bool bTriggerChanged = !FMath::IsNearlyEqual(TriggerValue, State.LastTrigger);
+
+		if (!bMoved && !bTurned && !bTriggerChanged)
+		{
+			++PosesDeduplicated;
+			return false;
+		}
+	}
+
+	// Only a send consumes a slot, so a change right after a deduplicated pose goes out at once
+	if (Config.MaxRateHz > 0.0f)
+	{
+		const double Interval = 1.0 / Config.MaxRateHz;
+		State.NextSendTime = FMath::Max(State.NextSendTime + Interval, Now - Interval);
+	}
+
+	State.LastPose = Pose;
+	State.LastTrigger = TriggerValue;
+	State.LastSendTime = Now;
+	State.LastEndpoint = Endpoint;
+	return true;
+}
+
+void UComLink::SubmitPose(EMsgType Type, const FTrackedPose& Pose, float TriggerValue)
+{
+	if (PoseSender)
+	{
+		// Staged until FlushSends publishes the frame's poses to the sender thread
+		const int32 Index = PoseStreamIndex(Type);
+		PendingPoses.Poses[Index] = Pose;
+		PendingPoses.Triggers[Index] = TriggerValue;
+		PendingPoses.UpdateTimes[Index] = FPlatformTime::Seconds();
+		PendingPoses.Endpoints[Index] = PoseEndpoint(Type);
+		bPosesStaged = true;
+		return;
+	}
+
+	const uint8 Endpoint = PoseEndpoint(Type);
+	if (!ShouldSendPose(Type, Endpoint, Pose, TriggerValue)) return;
+
+	FWirePose Wire;
+	BuildWirePose(Type, Endpoint, Pose, TriggerValue, Wire);
+	EncodePose(Endpoint, Wire, [this](const uint8* Data, int32 Size) { Socket->queue_send(Data, Size); });
+}
 
-	msgpack::sbuffer buf = Wire.Pack();
-	Socket->send_raw(reinterpret_cast<const uint8*>(buf.data()), buf.size());
+uint8 UComLink::PoseEndpoint(EMsgType Type) const
+{
+	return static_cast<uint8>(Type == EMsgType::HeadPose ? CameraEndpoint : ArmEndpoint);
+}
+
+void UComLink::BuildWirePose(EMsgType Type, uint8 Endpoint, const FTrackedPose& Pose, float TriggerValue, FWirePose& Out)
+{
+	Out.Timestamp = static_cast<uint64>(FPlatformTime::Seconds() * 1e9);
+	Out.Sequence = NextSequence(Endpoint, Type);
+	Out.Type = static_cast<uint8>(Type);
+	Out.TriggerValue = static_cast<double>(TriggerValue);
+
+	CoordConvert::UnrealToProtocol(Pose.Position, Out.PX, Out.PY, Out.PZ);
+	CoordConvert::UnrealToProtocolQuat(Pose.Orientation, Out.QX, Out.QY, Out.QZ, Out.QW);
+}
+
+void UComLink::EncodePose(uint8 Endpoint, const FWirePose& Wire, TFunctionRef<void(const uint8*, int32)> Emit) const
+{
+	if (UseCompactEncoding())
+	{
+		FWirePose::FCompactBuffer Buf;
+		Wire.PackCompact(Buf, bCompressQuaternions);
+		EmitTo(Endpoint, Buf.GetData(), Buf.Num(), Emit);
+	}
+	else
+	{
+		FWirePose::FPackBuffer Buf;
+		Wire.Pack(Buf);
+		EmitTo(Endpoint, Buf.GetData(), Buf.Num(), Emit);
+	}
+}
+
+void UComLink::RunPoseSendCycle()
+{
+	PoseSnapshot.Update();
+	const FPoseSnapshot& Snapshot = PoseSnapshot.GetReadBuffer();
+	const double Now = FPlatformTime::Seconds();
+
+	SenderBatchData.Reset();
+	SenderBatchSizes.Reset();
+
+	for (int32 Index = 0; Index < NumPoseStreams; ++Index)
+	{
+		// Hold the last pose across frame hitches, but never keep commanding a stale one
+		const double UpdateTime = Snapshot.UpdateTimes[Index];
+		if (UpdateTime < 0.0 || Now - UpdateTime > PoseHoldTimeout) continue;
+
+		const EMsgType Type = PoseStreamType(Index);
+		const uint8 Endpoint = Snapshot.Endpoints[Index];
+		if (!ShouldSendPose(Type, Endpoint, Snapshot.Poses[Index], Snapshot.Triggers[Index])) continue;
+
+		FWirePose Wire;
+		BuildWirePose(Type, Endpoint, Snapshot.Poses[Index], Snapshot.Triggers[Index], Wire);
+		EncodePose(Endpoint, Wire, [this](const uint8* Data, int32 Size)
+		{
+			SenderBatchData.Append(Data, Size);
+			SenderBatchSizes.Add(Size);
+		});
+	}
+
+	if (SenderBatchSizes.Num() > 0)
+	{
+		Socket->send_batch(SenderBatchData.GetData(), SenderBatchSizes.GetData(), SenderBatchSizes.Num());
+	}
+}
+
+int32 UComLink::PoseStreamIndex(EMsgType Type)
+{
+	switch (Type)
+	{
+	case EMsgType::HandLeft:	return 1;
+	case EMsgType::HandRight:	return 2;
+	default:					return 0;
+	}
+}
+
+EMsgType UComLink::PoseStreamType(int32 Index)
+{
+	static constexpr EMsgType Types[NumPoseStreams] = { EMsgType::HeadPose, EMsgType::HandLeft, EMsgType::HandRight };
+	return Types[Index];
+}
+
+bool UComLink::UseCompactEncoding() const
+{
+	switch (WireEncoding)
+	{
+	case EWireEncoding::Compact:	return true;
+	case EWireEncoding::Auto:		return bRemoteSendsCompact;
+	default:						return false;
+	}
+}
+
+void UComLink::FlushSends()
+{
+	if (!Socket) return;
+
+	if (PoseSender && bPosesStaged)
+	{
+		PoseSnapshot.GetWriteBuffer() = PendingPoses;
+		PoseSnapshot.Publish();
+		bPosesStaged = false;
+	}
+	Socket->flush_sends();
 }
 
 // ============================================================================
@@ -105,76 +535,468 @@ void UComLink::ProcessIncoming()
 {
 	if (!Socket || !Socket->has_new_data()) return;
 
-	TArray<uint8> RawData = Socket->get_raw_data();
-	if (RawData.Num() > 0)
+	// One mailbox per endpoint and message type, so a left-arm state is never lost to a right-arm state
+	Socket->drain([this](const FRawPacket& Packet)
 	{
-		RouteMessage(reinterpret_cast<const char*>(RawData.GetData()), RawData.Num());
-	}
+		// A looping replay starts its sequence numbers over with each pass
+		if (Replay && Replay->GetLoopCount() != ReplayLoops)
+		{
+			ReplayLoops = Replay->GetLoopCount();
+			RestartRemoteSequences();
+		}
+		RouteMessage(Packet.Endpoint, Packet.Data.GetData(), Packet.Data.Num(), Packet.ReceiveTime);
+	});
 }
 
-void UComLink::RouteMessage(const char* Data, int32 Size)
+void UComLink::RouteMessage(uint8 Endpoint, const uint8* Data, int32 Size, double ReceiveTime)
 {
-	try
+	uint8 MsgType = 0;
+	if (!FWireReader::PeekType(Data, Size, MsgType))
 	{
-		auto oh = msgpack::unpack(Data, Size);
-		const msgpack::object& obj = oh.get();
+		UE_LOG(LogTemp, Warning, TEXT("ComLink: Dropped malformed packet (%d bytes)"), Size);
+		return;
+	}
 
-		if (obj.type != msgpack::type::ARRAY || obj.via.array.size < 3) return;
+	double Now = FPlatformTime::Seconds();
+	EWireDecodeResult Result = EWireDecodeResult::Ok;
+	const bool bCompact = CompactWire::IsCompact(Data, Size);
 
-		uint8 MsgType = obj.via.array.ptr[2].as<uint8>();
-		double Now = FPlatformTime::Seconds();
+	FEndpointState& Remote = GetEndpointState(Endpoint);
+	KnownEndpoints |= 1u << Endpoint;
+	const bool bFromArm = (Endpoint == ArmEndpoint);
 
-		switch (static_cast<EMsgType>(MsgType))
+	switch (static_cast<EMsgType>(MsgType))
+	{
+	case EMsgType::RobotStateRight:
+	case EMsgType::RobotStateLeft:
+	{
+		FWireRobotState State;
+		Result = State.Decode(Data, Size);
+		if (Result == EWireDecodeResult::Ok && AcceptSequence(Endpoint, MsgType, State.Sequence, ReceiveTime))
 		{
-		case EMsgType::RobotStateRight:
-		case EMsgType::RobotStateLeft:
+			OnRobotStateKeyframe(Endpoint, State);
+
+			Remote.LastReceiveTime = Now;
+			UpdateLatency(Endpoint, State.Timestamp, ReceiveTime);
+			OnEndpointRobotStateReceived.Broadcast(Endpoint, State);
+			if (bFromArm) OnRobotStateReceived.Broadcast(State);
+		}
+		break;
+	}
+	case EMsgType::RobotStateDeltaRight:
+	case EMsgType::RobotStateDeltaLeft:
+	{
+		FWireRobotStateDelta Delta;
+		Result = Delta.Decode(Data, Size);
+
+		FWireRobotState State;
+		if (Result == EWireDecodeResult::Ok && AcceptSequence(Endpoint, MsgType, Delta.Sequence, ReceiveTime) &&
+			ApplyStateDelta(Endpoint, Delta, State))
 		{
-			FWireRobotState State;
-			if (State.Unpack(obj))
-			{
-				LastReceiveTime = Now;
-				LastLatencyMs = static_cast<float>((Now * 1e9 - State.Timestamp) / 1e6);
-				OnRobotStateReceived.Broadcast(State);
-			}
-			break;
+			Remote.LastReceiveTime = Now;
+			UpdateLatency(Endpoint, State.Timestamp, ReceiveTime);
+			OnEndpointRobotStateReceived.Broadcast(Endpoint, State);
+			if (bFromArm) OnRobotStateReceived.Broadcast(State);
 		}
-		case EMsgType::PanTiltState:
+		break;
+	}
+	case EMsgType::PanTiltState:
+	{
+		FWirePanTiltState State;
+		Result = State.Decode(Data, Size);
+		if (Result == EWireDecodeResult::Ok && AcceptSequence(Endpoint, MsgType, State.Sequence, ReceiveTime))
 		{
-			FWirePanTiltState State;
-			if (State.Unpack(obj))
-			{
-				LastReceiveTime = Now;
-				OnPanTiltStateReceived.Broadcast(State);
-			}
-			break;
+			Remote.LastReceiveTime = Now;
+			OnEndpointPanTiltStateReceived.Broadcast(Endpoint, State);
+			if (Endpoint == CameraEndpoint) OnPanTiltStateReceived.Broadcast(State);
 		}
-		case EMsgType::SystemStatus:
+		break;
+	}
+	case EMsgType::SystemStatus:
+	{
+		FWireSystemStatus Status;
+		Result = Status.Decode(Data, Size);
+		if (Result == EWireDecodeResult::Ok && AcceptSequence(Endpoint, MsgType, Status.Sequence, ReceiveTime))
 		{
-			FWireSystemStatus Status;
-			if (Status.Unpack(obj))
-			{
-				LastReceiveTime = Now;
-				OnSystemStatusReceived.Broadcast(Status);
-			}
-			break;
+			Remote.LastReceiveTime = Now;
+			OnEndpointSystemStatusReceived.Broadcast(Endpoint, Status);
+			if (bFromArm) OnSystemStatusReceived.Broadcast(Status);
+		}
+		break;
+	}
+	case EMsgType::CommandAck:
+	{
+		FWireCommandAck Ack;
+		Result = Ack.Decode(Data, Size);
+		if (Result == EWireDecodeResult::Ok)
+		{
+			Remote.LastReceiveTime = Now;
+			Commands.Acknowledge(Endpoint, Ack.AckedType, Ack.AckedSequence, ReceiveTime);
+		}
+		break;
+	}
+	case EMsgType::TimeSyncPong:
+	{
+		FWireTimeSyncPong Pong;
+		Result = Pong.Decode(Data, Size);
+		if (Result == EWireDecodeResult::Ok)
+		{
+			OnTimeSyncPong(Endpoint, Pong, ReceiveTime);
 		}
+		break;
+	}
+	default:
+		UE_LOG(LogTemp, Warning, TEXT("ComLink: Unknown message type 0x%02X from endpoint %d"), MsgType, Endpoint);
+		break;
+	}
+
+	if (Result == EWireDecodeResult::Ok && bCompact && !bRemoteSendsCompact)
+	{
+		// Remote understands the compact encoding; Auto mode switches outbound over
+		bRemoteSendsCompact = true;
+		UE_LOG(LogTemp, Log, TEXT("ComLink: Remote uses compact encoding"));
+	}
+	else if (Result != EWireDecodeResult::Ok)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ComLink: Decode failed for type 0x%02X  %s"), MsgType, LexToString(Result));
+	}
+}
+
+// ============================================================================
+// Robot-state telemetry
+// ============================================================================
+
+FRobotStateTelemetry* UComLink::EnsureTelemetry()
+{
+	if (!Telemetry)
+	{
+		Telemetry = MakeUnique<FRobotStateTelemetry>(TelemetryRingCapacity);
+	}
+	return Telemetry.Get();
+}
+
+int32 UComLink::SubscribeRobotStates(const TCHAR* Name, FRobotStateTelemetry::FCallback Callback)
+{
+	return EnsureTelemetry()->Subscribe(Name, MoveTemp(Callback));
+}
+
+void UComLink::UnsubscribeRobotStates(int32 Handle)
+{
+	if (Telemetry)
+	{
+		Telemetry->Unsubscribe(Handle);
+	}
+}
+
+bool UComLink::GetLatestRobotState(bool bLeft, FWireRobotState& Out)
+{
+	return Telemetry && Telemetry->GetLatest(bLeft, Out);
+}
+
+// ============================================================================
+// Per-stream sequence tracking
+// ============================================================================
+
+bool UComLink::AcceptSequence(uint8 Endpoint, uint8 MsgType, uint32 Sequence, double ReceiveTime)
+{
+	const EComStream Stream = StreamForType(MsgType);
+	if (Stream == EComStream::Count) return true;
+
+	// Deltas continue their arm's sequence, so local drops of both types feed one tracker
+	uint32 LocalDrops = 0;
+	if (Socket)
+	{
+		switch (Stream)
+		{
+		case EComStream::RobotStateRight:
+			LocalDrops = Socket->get_dropped_count(Endpoint, static_cast<uint8>(EMsgType::RobotStateRight)) +
+				Socket->get_dropped_count(Endpoint, static_cast<uint8>(EMsgType::RobotStateDeltaRight));
+			break;
+		case EComStream::RobotStateLeft:
+			LocalDrops = Socket->get_dropped_count(Endpoint, static_cast<uint8>(EMsgType::RobotStateLeft)) +
+				Socket->get_dropped_count(Endpoint, static_cast<uint8>(EMsgType::RobotStateDeltaLeft));
+			break;
 		default:
-			UE_LOG(LogTemp, Warning, TEXT("ComLink: Unknown message type 0x%02X"), MsgType);
+			LocalDrops = Socket->get_dropped_count(Endpoint, MsgType);
 			break;
 		}
 	}
-	catch (const std::exception& ex)
+
+	const FSequenceTracker::EVerdict Verdict =
+		GetEndpointState(Endpoint).StreamTrackers[static_cast<int32>(Stream)].Observe(Sequence, ReceiveTime, LocalDrops);
+
+	if (Verdict != FSequenceTracker::EVerdict::Accept)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("ComLink: Dropped %s packet 0x%02X seq %u from endpoint %d"),
+			Verdict == FSequenceTracker::EVerdict::Duplicate ? TEXT("duplicate") : TEXT("stale"), MsgType, Sequence, Endpoint);
+		return false;
+	}
+	return true;
+}
+
+EComStream UComLink::StreamForType(uint8 MsgType)
+{
+	switch (static_cast<EMsgType>(MsgType))
 	{
-		UE_LOG(LogTemp, Error, TEXT("ComLink: Unpack failed  %s"), UTF8_TO_TCHAR(ex.what()));
+	case EMsgType::RobotStateRight:
+	case EMsgType::RobotStateDeltaRight:	return EComStream::RobotStateRight;
+	case EMsgType::RobotStateLeft:
+	case EMsgType::RobotStateDeltaLeft:		return EComStream::RobotStateLeft;
+	case EMsgType::PanTiltState:			return EComStream::PanTilt;
+	case EMsgType::SystemStatus:			return EComStream::SystemStatus;
+	default:								return EComStream::Count;
 	}
 }
 
-bool UComLink::IsConnected() const
+const FComStreamStats& UComLink::GetStreamStats(EComStream Stream) const
+{
+	return GetEndpointStreamStats(static_cast<uint8>(Stream == EComStream::PanTilt ? CameraEndpoint : ArmEndpoint), Stream);
+}
+
+const FComStreamStats& UComLink::GetEndpointStreamStats(uint8 Endpoint, EComStream Stream) const
 {
-	return (FPlatformTime::Seconds() - LastReceiveTime) < ConnectionTimeout;
+	const int32 Index = FMath::Clamp(static_cast<int32>(Stream), 0, static_cast<int32>(EComStream::Count) - 1);
+	return GetEndpointState(Endpoint).StreamTrackers[Index].GetStats();
 }
 
-uint32 UComLink::NextSequence()
+float UComLink::GetPacketLossPercent() const
 {
-	return ++SequenceCounter;
-}
\ No newline at end of file
+	int32 Lost = 0;
+	int32 Expected = 0;
+	for (const FEndpointState& Remote : EndpointStates)
+	{
+		for (const FSequenceTracker& Tracker : Remote.StreamTrackers)
+		{
+			const FComStreamStats& Stats = Tracker.GetStats();
+			Lost += Stats.Lost;
+			Expected += Stats.Received + Stats.Reordered + Stats.Lost + Stats.Superseded;
+		}
+	}
+	return Expected > 0 ? 100.0f * Lost / Expected : 0.0f;
+}
+
+void UComLink::RestartRemoteSequences()
+{
+	for (FEndpointState& Remote : EndpointStates)
+	{
+		for (FSequenceTracker& Tracker : Remote.StreamTrackers)
+		{
+			Tracker.Restart();
+		}
+
+		// Keyframes are referenced by sequence number, so the old ones could be mistaken for new
+		for (FKeyframeHistory& History : Remote.Keyframes)
+		{
+			History = FKeyframeHistory();
+		}
+	}
+}
+
+void UComLink::ResetStreamStats()
+{
+	for (FEndpointState& Remote : EndpointStates)
+	{
+		for (FSequenceTracker& Tracker : Remote.StreamTrackers)
+		{
+			Tracker.Reset();
+		}
+	}
+}
+
+// ============================================================================
+// Robot-state delta stream
+// ============================================================================
+
+void UComLink::OnRobotStateKeyframe(uint8 Endpoint, const FWireRobotState& State)
+{
+	if (!bEnableStateDeltas) return;
+
+	// Every full state could serve as a keyframe, but only acknowledged ones are
+	// stored, so the history always holds what the remote may reference.
+	FKeyframeHistory& History = GetEndpointState(Endpoint).Keyframes[KeyframeArmIndex(State.Type)];
+	const double Now = FPlatformTime::Seconds();
+	if (History.LastAckTime >= 0.0 && Now - History.LastAckTime < KeyframeAckInterval) return;
+
+	History.States[History.Next] = State;
+	History.Next = (History.Next + 1) % NumKeyframeSlots;
+	History.Count = FMath::Min(History.Count + 1, NumKeyframeSlots);
+	History.LastAckTime = Now;
+
+	SendStateAck(Endpoint, State.Type, State.Sequence);
+}
+
+bool UComLink::ApplyStateDelta(uint8 Endpoint, const FWireRobotStateDelta& Delta, FWireRobotState& OutState)
+{
+	FKeyframeHistory& History = GetEndpointState(Endpoint).Keyframes[KeyframeArmIndex(StateDelta::KeyframeType(Delta.Type))];
+
+	for (int32 i = 0; i < History.Count; ++i)
+	{
+		const FWireRobotState& Keyframe = History.States[i];
+		if (Keyframe.Sequence == Delta.KeyframeSequence)
+		{
+			Delta.ApplyTo(Keyframe, OutState);
+			++DeltasApplied;
+			return true;
+		}
+	}
+
+	// Unknown reference: acknowledge the next full state immediately to resync
+	++DeltaMisses;
+	History.LastAckTime = -1.0;
+	return false;
+}
+
+void UComLink::SendStateAck(uint8 Endpoint, uint8 StateType, uint32 KeyframeSequence)
+{
+	if (!Socket) return;
+
+	FWireStateAck Wire;
+	Wire.Timestamp = static_cast<uint64>(FPlatformTime::Seconds() * 1e9);
+	Wire.Sequence = NextSequence(Endpoint, EMsgType::StateAck);
+	Wire.StateType = StateType;
+	Wire.KeyframeSequence = KeyframeSequence;
+
+	// Back to the endpoint whose keyframe it acknowledges
+	auto QueueSend = [this](const uint8* Data, int32 Size) { Socket->queue_send(Data, Size); };
+	if (UseCompactEncoding())
+	{
+		FWireStateAck::FCompactBuffer Buf;
+		Wire.PackCompact(Buf);
+		EmitTo(Endpoint, Buf.GetData(), Buf.Num(), QueueSend);
+	}
+	else
+	{
+		FWireStateAck::FPackBuffer Buf;
+		Wire.Pack(Buf);
+		EmitTo(Endpoint, Buf.GetData(), Buf.Num(), QueueSend);
+	}
+}
+
+int32 UComLink::KeyframeArmIndex(uint8 StateType)
+{
+	return StateType == static_cast<uint8>(EMsgType::RobotStateLeft) ? 1 : 0;
+}
+
+// ============================================================================
+// Clock synchronization
+// ============================================================================
+
+void UComLink::SendTimeSyncPing(uint8 Endpoint)
+{
+	FWireTimeSyncPing Wire;
+	Wire.Sequence = NextSequence(Endpoint, EMsgType::TimeSyncPing);
+
+	// Sent immediately and stamped last, so T0 excludes local queuing
+	auto SendNow = [this](const uint8* Data, int32 Size) { Socket->send_raw(Data, Size); };
+	if (UseCompactEncoding())
+	{
+		FWireTimeSyncPing::FCompactBuffer Buf;
+		Wire.Timestamp = NowNs();
+		Wire.PackCompact(Buf);
+		EmitTo(Endpoint, Buf.GetData(), Buf.Num(), SendNow);
+	}
+	else
+	{
+		FWireTimeSyncPing::FPackBuffer Buf;
+		Wire.Timestamp = NowNs();
+		Wire.Pack(Buf);
+		EmitTo(Endpoint, Buf.GetData(), Buf.Num(), SendNow);
+	}
+}
+
+void UComLink::OnTimeSyncPong(uint8 Endpoint, const FWireTimeSyncPong& Pong, double ReceiveTime)
+{
+	// T3 is the receive thread's arrival time, not the (later) game-thread tick
+	const uint64 T3 = static_cast<uint64>(ReceiveTime * 1e9);
+	FClockSync& ClockSync = GetEndpointState(Endpoint).ClockSync;
+	const bool bFirst = !ClockSync.IsSynchronized();
+
+	if (!ClockSync.AddSample(Pong.OriginTimestamp, Pong.ReceiveTimestamp, Pong.Timestamp, T3))
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("ComLink: Rejected inconsistent time-sync pong from endpoint %d (seq %u)"), Endpoint, Pong.Sequence);
+		return;
+	}
+
+	if (bFirst)
+	{
+		UE_LOG(LogTemp, Log, TEXT("ComLink: Clock of endpoint %d synchronized  offset %.3f ms, RTT %.3f ms"),
+			Endpoint, ClockSync.GetOffsetNs(T3) / 1e6, ClockSync.GetRoundTripMs());
+	}
+}
+
+void UComLink::UpdateLatency(uint8 Endpoint, uint64 RemoteTimestamp, double ReceiveTime)
+{
+	// Without an offset estimate the two clocks cannot be compared
+	FEndpointState& Remote = GetEndpointState(Endpoint);
+	if (!Remote.ClockSync.IsSynchronized()) return;
+
+	const uint64 LocalNs = static_cast<uint64>(ReceiveTime * 1e9);
+	const int64 LatencyNs = static_cast<int64>(LocalNs - Remote.ClockSync.RemoteToLocal(RemoteTimestamp, LocalNs));
+	const float LatencyMs = static_cast<float>(LatencyNs / 1e6);
+
+	if (Remote.bHasLatency)
+	{
+		Remote.LatencyJitterMs += (FMath::Abs(LatencyMs - Remote.LastLatencyMs) - Remote.LatencyJitterMs) / 16.0f;
+	}
+	Remote.LastLatencyMs = LatencyMs;
+	Remote.bHasLatency = true;
+}
+
+bool UComLink::IsEndpointConnected(uint8 Endpoint) const
+{
+	return (FPlatformTime::Seconds() - GetEndpointState(Endpoint).LastReceiveTime) < ConnectionTimeout;
+}
+
+uint32 UComLink::NextSequence(uint8 Endpoint, EMsgType Type)
+{
+	return ++GetEndpointState(Endpoint).SequenceCounters[static_cast<uint8>(Type)];
+}
+
+// ============================================================================
+// Micro-benchmark: heap (sbuffer) vs fixed-buffer encoding of the hot send path
+// Usage: TeleOp.BenchWirePack [Iterations]
+// ============================================================================
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommand GBenchWirePackCommand(
+	TEXT("TeleOp.BenchWirePack"),
+	TEXT("Compare FWirePose::Pack() into msgpack::sbuffer against the fixed-buffer overload."),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000000;
+
+		FWirePose Wire;
+		Wire.Timestamp = static_cast<uint64>(FPlatformTime::Seconds() * 1e9);
+		Wire.Type = static_cast<uint8>(EMsgType::HandRight);
+		Wire.PX = 0.41; Wire.PY = -0.12; Wire.PZ = 1.07;
+		Wire.QX = 0.01; Wire.QY = 0.70; Wire.QZ = -0.02; Wire.QW = 0.71;
+		Wire.TriggerValue = 1.0;
+
+		volatile int64 Sink = 0;
+
+		const double HeapStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			Wire.Sequence = i;
+			msgpack::sbuffer buf = Wire.Pack();
+			Sink = Sink + buf.size();
+		}
+		const double HeapSeconds = FPlatformTime::Seconds() - HeapStart;
+
+		const double FixedStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			Wire.Sequence = i;
+			FWirePose::FPackBuffer Buf;
+			Wire.Pack(Buf);
+			Sink = Sink + Buf.Num();
+		}
+		const double FixedSeconds = FPlatformTime::Seconds() - FixedStart;
+
+		UE_LOG(LogTemp, Log, TEXT("ComLink: BenchWirePack x%d | sbuffer: %.1f ns/msg | fixed: %.1f ns/msg | speedup %.2fx"),
+			Iterations,
+			HeapSeconds * 1e9 / Iterations,
+			FixedSeconds * 1e9 / Iterations,
+			FixedSeconds > 0.0 ? HeapSeconds / FixedSeconds : 0.0);
+	}));
+#endif
@@ -0,0 +1,74 @@
+#include "FixedRateThread.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+FFixedRateThread::FFixedRateThread(const TCHAR* ThreadName, double InRateHz, TFunction<void()> InCycle,
+	EThreadPriority Priority)
+	: RateHz(FMath::Max(InRateHz, 1.0))
+	, Cycle(MoveTemp(InCycle))
+{
+	Thread = FRunnableThread::Create(this, ThreadName, 0, Priority);
+	if (!Thread)
+	{
+		UE_LOG(LogTemp, Error, TEXT("FixedRateThread: Failed to create thread %s"), ThreadName);
+	}
+}
+
+FFixedRateThread::~FFixedRateThread()
+{
+	Shutdown();
+}
+
+void FFixedRateThread::Shutdown()
+{
+	if (Thread)
+	{
+		bStop = true;
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+uint32 FFixedRateThread::Run()
+{
+	const double Period = 1.0 / RateHz;
+	double Deadline = FPlatformTime::Seconds() + Period;
+	double LastStart = -1.0;
+	float Jitter = 0.0f;
+
+	while (!bStop)
+	{
+		for (;;)
+		{
+			const double Remaining = Deadline - FPlatformTime::Seconds();
+			if (Remaining <= 0.0) break;
+
+			FPlatformProcess::SleepNoStats(Remaining > SpinThresholdSeconds
+				? static_cast<float>(Remaining - SpinThresholdSeconds)
+				: 0.0f);
+		}
+		if (bStop) break;
+
+		const double Start = FPlatformTime::Seconds();
+		if (LastStart >= 0.0)
+		{
+			const float ErrorUs = static_cast<float>(FMath::Abs((Start - LastStart) - Period) * 1e6);
+			Jitter += (ErrorUs - Jitter) / 16.0f;
+			PeriodJitterUs.Store(Jitter);
+		}
+		LastStart = Start;
+
+		Cycle();
+		++Cycles;
+
+		Deadline += Period;
+		const double Now = FPlatformTime::Seconds();
+		if (Now - Deadline > Period)
+		{
+			++Overruns;
+			Deadline = Now + Period;
+		}
+	}
+	return 0;
+}
@@ -93,6 +93,24 @@ float UHUDPanelBase::GetComLatency() const
 	return 0.0f;
 }
 
+float UHUDPanelBase::GetComPacketLoss() const
+{
+	if (ComLinkRef)
+	{
+		return ComLinkRef->GetPacketLossPercent();
+	}
+	return 0.0f;
+}
+
+FComStreamStats UHUDPanelBase::GetComStreamStats(EComStream Stream) const
+{
+	if (ComLinkRef)
+	{
+		return ComLinkRef->GetStreamStats(Stream);
+	}
+	return FComStreamStats();
+}
+
 bool UHUDPanelBase::GetComConnected() const
 {
 	if (ComLinkRef)
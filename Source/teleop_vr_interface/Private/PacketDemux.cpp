@@ -0,0 +1,133 @@
+#include "PacketDemux.h"
+#include "TeleOpTypes.h"
+
+FPacketDemux::FPacketDemux()
+{
+	for (TAtomic<FPacketRing*>& Queue : Queues) Queue = nullptr;
+}
+
+bool FPacketDemux::Dispatch(const uint8* Data, int32 Size, double ReceiveTime)
+{
+	uint8 Endpoint = 0;
+	uint8 MsgType = 0;
+	if (!EndpointWire::Split(Data, Size, Endpoint) || !FWireReader::PeekType(Data, Size, MsgType))
+	{
+		++MalformedPackets;
+		return false;
+	}
+
+	if (bHasObserver)
+	{
+		Observer(Endpoint, MsgType, Data, Size, ReceiveTime);
+	}
+
+	const int32 Route = RouteIndex(Endpoint, MsgType);
+	if (FPacketRing* Queue = Queues[Route].Load())
+	{
+		Queue->Push(Data, Size, ReceiveTime, Endpoint);
+	}
+	else
+	{
+		Mailboxes[Route].Write(Data, Size, ReceiveTime, Endpoint);
+	}
+
+	// Set once per endpoint; the packet itself is published by bNewData below
+	const uint32 EndpointBit = 1u << Endpoint;
+	if (!(SeenEndpoints.Load(EMemoryOrder::Relaxed) & EndpointBit))
+	{
+		SeenEndpoints |= EndpointBit;
+	}
+	bNewData = true;
+	return true;
+}
+
+bool FPacketDemux::IsBacklogged(uint8 Endpoint, uint8 MsgType) const
+{
+	const int32 Route = RouteIndex(Endpoint, MsgType);
+	if (const FPacketRing* Queue = Queues[Route].Load())
+	{
+		return Queue->IsFull();
+	}
+	return Mailboxes[Route].HasUnread();
+}
+
+void FPacketDemux::Drain(TFunctionRef<void(const FRawPacket&)> Visitor)
+{
+	// Clear before scanning: a packet published mid-scan re-raises the flag
+	bNewData = false;
+
+	const uint32 Endpoints = SeenEndpoints.Load();
+	for (int32 Endpoint = 0; Endpoint < MaxEndpoints; ++Endpoint)
+	{
+		if (!(Endpoints & (1u << Endpoint))) continue;
+
+		for (int32 MsgType = 0; MsgType < NumMsgTypes; ++MsgType)
+		{
+			const int32 Route = RouteIndex(static_cast<uint8>(Endpoint), static_cast<uint8>(MsgType));
+			if (FPacketRing* Queue = Queues[Route].Load())
+			{
+				while (const FRawPacket* Packet = Queue->Peek())
+				{
+					Visitor(*Packet);
+					Queue->Pop();
+				}
+			}
+
+			// Also checked for queued types: packets may have landed here before EnableQueue
+			if (const FRawPacket* Packet = Mailboxes[Route].Read())
+			{
+				Visitor(*Packet);
+			}
+		}
+	}
+}
+
+void FPacketDemux::EnableQueue(uint8 MsgType, int32 Capacity)
+{
+	for (int32 Endpoint = 0; Endpoint < MaxEndpoints; ++Endpoint)
+	{
+		const int32 Route = RouteIndex(static_cast<uint8>(Endpoint), MsgType);
+		if (Queues[Route].Load()) continue;
+
+		QueueStorage.Add(MakeUnique<FPacketRing>(Capacity));
+		Queues[Route] = QueueStorage.Last().Get();
+	}
+}
+
+void FPacketDemux::SetObserver(FObserver InObserver)
+{
+	if (bHasObserver)
+	{
+		UE_LOG(LogTemp, Error, TEXT("PacketDemux: Receive observer already set"));
+		return;
+	}
+
+	// Published by the flag, so the producer never sees a half-assigned function
+	Observer = MoveTemp(InObserver);
+	bHasObserver = true;
+}
+
+uint32 FPacketDemux::GetDroppedCount() const
+{
+	uint32 Dropped = MalformedPackets.Load();
+	for (int32 Route = 0; Route < MaxEndpoints * NumMsgTypes; ++Route)
+	{
+		Dropped += Mailboxes[Route].GetOverwrittenCount();
+		if (const FPacketRing* Queue = Queues[Route].Load())
+		{
+			Dropped += Queue->GetDroppedCount();
+		}
+	}
+	return Dropped;
+}
+
+uint32 FPacketDemux::GetDroppedCount(uint8 Endpoint, uint8 MsgType) const
+{
+	const int32 Route = RouteIndex(Endpoint, MsgType);
+	uint32 Dropped = Mailboxes[Route].GetOverwrittenCount();
+	if (const FPacketRing* Queue = Queues[Route].Load())
+	{
+		Dropped += Queue->GetDroppedCount();
+	}
+	return Dropped;
+}
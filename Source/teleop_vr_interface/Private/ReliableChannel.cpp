@@ -0,0 +1,140 @@
+#include "ReliableChannel.h"
+
+void FReliableChannel::Submit(uint8 Endpoint, uint8 MsgType, uint32 Sequence, uint32 SupersedeKey, const uint8* Data, int32 Size,
+	FOnCommandComplete OnComplete, double Now, FSendFunction Send)
+{
+	TArray<FPendingCommand, TInlineAllocator<2>> Replaced;
+	for (int32 i = Pending.Num() - 1; i >= 0; --i)
+	{
+		if (Pending[i].Endpoint == Endpoint && Pending[i].MsgType == MsgType && Pending[i].SupersedeKey == SupersedeKey)
+		{
+			++Stats.Superseded;
+			Replaced.Add(MoveTemp(Pending[i]));
+			Pending.RemoveAt(i);
+		}
+	}
+
+	FPendingCommand& Command = Pending.AddDefaulted_GetRef();
+	Command.Endpoint = Endpoint;
+	Command.MsgType = MsgType;
+	Command.Sequence = Sequence;
+	Command.SupersedeKey = SupersedeKey;
+	Command.Data.Append(Data, Size);
+	Command.OnComplete = MoveTemp(OnComplete);
+	Command.FirstSendTime = Now;
+	Command.Timeout = CurrentTimeout();
+	Command.NextRetryTime = Now + Command.Timeout;
+	Command.Attempts = 1;
+
+	Send(Command.Data.GetData(), Command.Data.Num());
+	++Stats.Sent;
+	Stats.InFlight = Pending.Num();
+
+	for (FPendingCommand& Old : Replaced)
+	{
+		Finish(MoveTemp(Old), ECommandResult::Superseded, 0.0f);
+	}
+}
+
+bool FReliableChannel::Acknowledge(uint8 Endpoint, uint8 MsgType, uint32 Sequence, double Now)
+{
+	const int32 Index = Pending.IndexOfByPredicate([Endpoint, MsgType, Sequence](const FPendingCommand& Command)
+	{
+		return Command.Endpoint == Endpoint && Command.MsgType == MsgType && Command.Sequence == Sequence;
+	});
+	if (Index == INDEX_NONE) return false;
+
+	const double Rtt = Now - Pending[Index].FirstSendTime;
+
+	// Karn's algorithm: an ack after a retransmission cannot be matched to one attempt
+	if (Pending[Index].Attempts == 1)
+	{
+		if (!bHasRtt)
+		{
+			SmoothedRtt = Rtt;
+			RttVariance = Rtt / 2.0;
+			bHasRtt = true;
+		}
+		else
+		{
+			RttVariance = 0.75 * RttVariance + 0.25 * FMath::Abs(SmoothedRtt - Rtt);
+			SmoothedRtt = 0.875 * SmoothedRtt + 0.125 * Rtt;
+		}
+	}
+
+	const float LatencyMs = static_cast<float>(Rtt * 1000.0);
+	++Stats.Confirmed;
+	Stats.LastLatencyMs = LatencyMs;
+	Stats.MeanLatencyMs += (LatencyMs - Stats.MeanLatencyMs) / Stats.Confirmed;
+	Stats.MaxLatencyMs = FMath::Max(Stats.MaxLatencyMs, LatencyMs);
+	Stats.RetransmitTimeoutMs = static_cast<float>(CurrentTimeout() * 1000.0);
+
+	FPendingCommand Command = MoveTemp(Pending[Index]);
+	Pending.RemoveAt(Index);
+	Stats.InFlight = Pending.Num();
+
+	Finish(MoveTemp(Command), ECommandResult::Confirmed, LatencyMs);
+	return true;
+}
+
+void FReliableChannel::Tick(double Now, FSendFunction Send)
+{
+	TArray<FPendingCommand, TInlineAllocator<2>> Expired;
+
+	for (int32 i = Pending.Num() - 1; i >= 0; --i)
+	{
+		FPendingCommand& Command = Pending[i];
+		if (Now < Command.NextRetryTime) continue;
+
+		if (Command.Attempts >= MaxAttempts)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ReliableChannel: Command 0x%02X seq %u to endpoint %d not confirmed after %d attempts"),
+				Command.MsgType, Command.Sequence, Command.Endpoint, Command.Attempts);
+			++Stats.TimedOut;
+			Expired.Add(MoveTemp(Command));
+			Pending.RemoveAt(i);
+			continue;
+		}
+
+		Send(Command.Data.GetData(), Command.Data.Num());
+		++Command.Attempts;
+		++Stats.Retransmits;
+
+		Command.Timeout = FMath::Min(Command.Timeout * 2.0, MaxTimeout);
+		Command.NextRetryTime = Now + Command.Timeout;
+	}
+	Stats.InFlight = Pending.Num();
+
+	for (FPendingCommand& Command : Expired)
+	{
+		Finish(MoveTemp(Command), ECommandResult::TimedOut, 0.0f);
+	}
+}
+
+void FReliableChannel::Cancel()
+{
+	TArray<FPendingCommand> Cancelled = MoveTemp(Pending);
+	Pending.Reset();
+	Stats.InFlight = 0;
+
+	for (FPendingCommand& Command : Cancelled)
+	{
+		Finish(MoveTemp(Command), ECommandResult::Cancelled, 0.0f);
+	}
+}
+
+double FReliableChannel::CurrentTimeout() const
+{
+	const double Timeout = bHasRtt ? SmoothedRtt + 4.0 * RttVariance : InitialTimeout;
+	return FMath::Clamp(Timeout, MinTimeout, MaxTimeout);
+}
+
+void FReliableChannel::Finish(FPendingCommand&& Command, ECommandResult Result, float LatencyMs)
+{
+	// Callers remove the command from Pending first, so callbacks may submit new ones
+	Command.OnComplete.ExecuteIfBound(Result, LatencyMs);
+	if (OnResult)
+	{
+		OnResult(Command.Endpoint, Command.MsgType, Command.Sequence, Result, LatencyMs);
+	}
+}
@@ -0,0 +1,260 @@
+#include "ReplayTransport.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "TeleOpTypes.h"
+
+// ============================================================================
+// Session reader
+// ============================================================================
+
+bool FSessionReader::Open(const FString& FilePath)
+{
+	FOpenMappedResult Result = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*FilePath);
+	if (Result.HasError())
+	{
+		UE_LOG(LogTemp, Error, TEXT("SessionReader: Failed to open %s"), *FilePath);
+		return false;
+	}
+	File = Result.StealValue();
+
+	Region.Reset(File->MapRegion(0, File->GetFileSize()));
+	if (!Region || Region->GetMappedSize() < static_cast<int64>(sizeof(FSessionFileHeader)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SessionReader: %s is empty or could not be mapped"), *FilePath);
+		Region.Reset();
+		return false;
+	}
+
+	FMemory::Memcpy(&Header, Region->GetMappedPtr(), sizeof(Header));
+	if (Header.Magic != SessionFile::FileMagic || Header.Version != SessionFile::Version)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SessionReader: %s is not a version %u session file"), *FilePath, SessionFile::Version);
+		Region.Reset();
+		return false;
+	}
+
+	Data = Region->GetMappedPtr();
+	Size = Region->GetMappedSize();
+	Rewind();
+	return true;
+}
+
+void FSessionReader::Rewind()
+{
+	Cursor = Header.HeaderSize;
+	ChunkEnd = Cursor;
+}
+
+const FSessionRecordHeader* FSessionReader::Next()
+{
+	if (!Data) return nullptr;
+
+	while (Cursor >= ChunkEnd)
+	{
+		FSessionChunkHeader Chunk;
+		if (Cursor + static_cast<int64>(sizeof(Chunk)) > Size) return nullptr;
+
+		FMemory::Memcpy(&Chunk, Data + Cursor, sizeof(Chunk));
+		if (Chunk.Magic != SessionFile::ChunkMagic ||
+			Cursor + static_cast<int64>(sizeof(Chunk)) + Chunk.PayloadBytes > Size)
+		{
+			return nullptr;
+		}
+		Cursor += sizeof(Chunk);
+		ChunkEnd = Cursor + Chunk.PayloadBytes;
+	}
+
+	// Records are 8-byte aligned within the mapping, so they can be used in place
+	const FSessionRecordHeader* Record = reinterpret_cast<const FSessionRecordHeader*>(Data + Cursor);
+	const int64 RecordBytes = SessionFile::AlignUp(sizeof(FSessionRecordHeader) + Record->Size);
+	if (Cursor + RecordBytes > ChunkEnd)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SessionReader: Corrupt record at offset %lld, stopping"), Cursor);
+		Cursor = ChunkEnd = Size;
+		return nullptr;
+	}
+	Cursor += RecordBytes;
+	return Record;
+}
+
+// ============================================================================
+// Replay transport
+// ============================================================================
+
+FReplayTransport::FReplayTransport(const FConfig& InConfig)
+	: Config(InConfig)
+{
+	if (!Reader.Open(Config.FilePath))
+	{
+		bFinished = true;
+		return;
+	}
+
+	Thread = FRunnableThread::Create(this, TEXT("ComLinkReplay"), 0, TPri_Normal);
+	if (!Thread)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ReplayTransport: Failed to create replay thread"));
+		bFinished = true;
+		return;
+	}
+
+	if (Config.Speed > 0.0f)
+	{
+		UE_LOG(LogTemp, Log, TEXT("ReplayTransport: Playing %s at %.2fx%s"),
+			*Config.FilePath, Config.Speed, Config.bLoop ? TEXT(", looping") : TEXT(""));
+	}
+	else
+	{
+		UE_LOG(LogTemp, Log, TEXT("ReplayTransport: Playing %s as fast as possible%s"),
+			*Config.FilePath, Config.bLoop ? TEXT(", looping") : TEXT(""));
+	}
+}
+
+FReplayTransport::~FReplayTransport()
+{
+	stop();
+}
+
+void FReplayTransport::stop()
+{
+	if (Thread)
+	{
+		bStop = true;
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+
+		UE_LOG(LogTemp, Log, TEXT("ReplayTransport: Stopped after %llu packets (%u sends discarded)"),
+			Replayed.Load(), DiscardedSends.Load());
+	}
+}
+
+bool FReplayTransport::has_new_data() const
+{
+	bConsumerReady = true;
+	return Demux.HasNewData();
+}
+
+void FReplayTransport::drain(TFunctionRef<void(const FRawPacket&)> Visitor)
+{
+	bConsumerReady = true;
+
+	// Set before Drain clears the new-data flag, so WaitForDrained never sees neither
+	bDraining = true;
+	Demux.Drain(Visitor);
+	bDraining = false;
+}
+
+void FReplayTransport::set_recorder(FSessionRecorder* Recorder)
+{
+	UE_LOG(LogTemp, Warning, TEXT("ReplayTransport: Recording a replayed session is not supported"));
+}
+
+bool FReplayTransport::isConnectionAlive() const
+{
+	return (FPlatformTime::Seconds() - LastDispatchTime.Load()) < 1.5;
+}
+
+uint32 FReplayTransport::Run()
+{
+	while (!bConsumerReady)
+	{
+		if (bStop) return 0;
+		FPlatformProcess::SleepNoStats(0.001f);
+	}
+
+	while (PlayOnce() && Config.bLoop)
+	{
+		// The next pass restarts the sequence numbers; the consumer must have seen the
+		// end of this one before the loop count tells it to restart its tracking
+		if (!WaitForDrained()) break;
+		++Loops;
+	}
+
+	bFinished = true;
+	UE_LOG(LogTemp, Log, TEXT("ReplayTransport: Finished %s (%llu packets)"), *Config.FilePath, Replayed.Load());
+	return 0;
+}
+
+bool FReplayTransport::PlayOnce()
+{
+	Reader.Rewind();
+
+	const double StartTime = FPlatformTime::Seconds();
+	double FirstRecordTime = -1.0;
+
+	while (const FSessionRecordHeader* Record = Reader.Next())
+	{
+		if (bStop) return false;
+		if (Record->Direction != static_cast<uint8>(ERecordDirection::Inbound)) continue;
+
+		const uint8* Payload = reinterpret_cast<const uint8*>(Record + 1);
+		const int32 PayloadSize = static_cast<int32>(Record->Size);
+
+		// Recorded as received, so the endpoint envelope is still in front
+		const uint8* Message = Payload;
+		int32 MessageSize = PayloadSize;
+		uint8 Endpoint = 0;
+		uint8 MsgType = 0;
+		const bool bHasType = EndpointWire::Split(Message, MessageSize, Endpoint) &&
+			FWireReader::PeekType(Message, MessageSize, MsgType);
+		if (bHasType && (MsgType == static_cast<uint8>(EMsgType::TimeSyncPong) ||
+			MsgType == static_cast<uint8>(EMsgType::CommandAck)))
+		{
+			continue;
+		}
+
+		if (FirstRecordTime < 0.0)
+		{
+			FirstRecordTime = Record->Time;
+		}
+
+		double ReceiveTime;
+		if (Config.Speed > 0.0f)
+		{
+			// Arrival on the recorded schedule, so inter-arrival statistics match the recording
+			ReceiveTime = StartTime + (Record->Time - FirstRecordTime) / Config.Speed;
+			WaitUntil(ReceiveTime);
+		}
+		else
+		{
+			if (Config.bWaitForConsumer && bHasType)
+			{
+				while (Demux.IsBacklogged(Endpoint, MsgType))
+				{
+					if (bStop) return false;
+					FPlatformProcess::SleepNoStats(0.0001f);
+				}
+			}
+			ReceiveTime = FPlatformTime::Seconds();
+		}
+
+		Demux.Dispatch(Payload, PayloadSize, ReceiveTime);
+		LastDispatchTime = FPlatformTime::Seconds();
+		++Replayed;
+	}
+	return !bStop;
+}
+
+bool FReplayTransport::WaitForDrained() const
+{
+	// Flag first: a drain that cleared it is still marked as draining until it is done
+	while (Demux.HasNewData() || bDraining.Load())
+	{
+		if (bStop) return false;
+		FPlatformProcess::SleepNoStats(0.0005f);
+	}
+	return true;
+}
+
+void FReplayTransport::WaitUntil(double Time) const
+{
+	for (;;)
+	{
+		const double Remaining = Time - FPlatformTime::Seconds();
+		if (Remaining <= 0.0 || bStop) return;
+
+		FPlatformProcess::SleepNoStats(Remaining > 0.001 ? static_cast<float>(Remaining - 0.0005) : 0.0f);
+	}
+}
@@ -0,0 +1,219 @@
+#include "RobotStateTelemetry.h"
+#include "HAL/PlatformProcess.h"
+
+FRobotStateTelemetry::FRobotStateTelemetry(int32 RingCapacity)
+	: Ring(RingCapacity)
+{
+	for (TAtomic<FSubscriber*>& Slot : Subscribers)
+	{
+		Slot = nullptr;
+	}
+}
+
+FRobotStateTelemetry::~FRobotStateTelemetry()
+{
+	for (int32 Handle = 0; Handle < MaxSubscribers; ++Handle)
+	{
+		Unsubscribe(Handle);
+	}
+}
+
+// ============================================================================
+// Producer (receive thread)
+// ============================================================================
+
+void FRobotStateTelemetry::OnPacket(uint8 MsgType, const uint8* Data, int32 Size, double ReceiveTime)
+{
+	switch (static_cast<EMsgType>(MsgType))
+	{
+	case EMsgType::RobotStateRight:
+	case EMsgType::RobotStateLeft:
+	{
+		FWireRobotState State;
+		if (State.Decode(Data, Size) != EWireDecodeResult::Ok) return;
+
+		FArmState& Arm = Arms[MsgType == static_cast<uint8>(EMsgType::RobotStateLeft) ? 1 : 0];
+		if (Arm.Sequence.Observe(State.Sequence, ReceiveTime, 0) != FSequenceTracker::EVerdict::Accept) return;
+
+		// Any full state may become the keyframe a later delta references
+		Arm.Keyframes[Arm.NextKeyframe] = State;
+		Arm.NextKeyframe = (Arm.NextKeyframe + 1) % NumCachedKeyframes;
+		Arm.NumKeyframes = FMath::Min(Arm.NumKeyframes + 1, NumCachedKeyframes);
+
+		Publish(State);
+		break;
+	}
+	case EMsgType::RobotStateDeltaRight:
+	case EMsgType::RobotStateDeltaLeft:
+	{
+		FWireRobotStateDelta Delta;
+		if (Delta.Decode(Data, Size) != EWireDecodeResult::Ok) return;
+
+		FArmState& Arm = Arms[MsgType == static_cast<uint8>(EMsgType::RobotStateDeltaLeft) ? 1 : 0];
+		if (Arm.Sequence.Observe(Delta.Sequence, ReceiveTime, 0) != FSequenceTracker::EVerdict::Accept) return;
+
+		for (int32 i = 0; i < Arm.NumKeyframes; ++i)
+		{
+			if (Arm.Keyframes[i].Sequence == Delta.KeyframeSequence)
+			{
+				FWireRobotState State;
+				Delta.ApplyTo(Arm.Keyframes[i], State);
+				Publish(State);
+				return;
+			}
+		}
+		++DeltaMisses;
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void FRobotStateTelemetry::RestartSequences()
+{
+	for (FArmState& Arm : Arms)
+	{
+		Arm.Sequence.Restart();
+		Arm.NumKeyframes = 0;
+		Arm.NextKeyframe = 0;
+	}
+}
+
+void FRobotStateTelemetry::Publish(const FWireRobotState& State)
+{
+	Ring.Publish(State);
+
+	const int32 ArmIndex = State.Type == static_cast<uint8>(EMsgType::RobotStateLeft) ? 1 : 0;
+	Latest[ArmIndex].GetWriteBuffer() = State;
+	Latest[ArmIndex].Publish();
+
+	++ActivePublishers;
+	for (TAtomic<FSubscriber*>& Slot : Subscribers)
+	{
+		if (FSubscriber* Subscriber = Slot.Load())
+		{
+			Subscriber->Wake();
+		}
+	}
+	--ActivePublishers;
+}
+
+// ============================================================================
+// Consumers
+// ============================================================================
+
+bool FRobotStateTelemetry::GetLatest(bool bLeft, FWireRobotState& Out)
+{
+	const int32 ArmIndex = bLeft ? 1 : 0;
+	if (Latest[ArmIndex].Update())
+	{
+		bHasLatest[ArmIndex] = true;
+	}
+	if (!bHasLatest[ArmIndex]) return false;
+
+	Out = Latest[ArmIndex].GetReadBuffer();
+	return true;
+}
+
+int32 FRobotStateTelemetry::Subscribe(const TCHAR* Name, FCallback Callback)
+{
+	for (int32 Handle = 0; Handle < MaxSubscribers; ++Handle)
+	{
+		if (!Subscribers[Handle].Load())
+		{
+			Subscribers[Handle] = new FSubscriber(Name, Ring, MoveTemp(Callback));
+			return Handle;
+		}
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("RobotStateTelemetry: No free subscriber slot for %s"), Name);
+	return INDEX_NONE;
+}
+
+void FRobotStateTelemetry::Unsubscribe(int32 Handle)
+{
+	if (Handle < 0 || Handle >= MaxSubscribers) return;
+
+	// A worker cannot join itself
+	const FSubscriber* Current = Subscribers[Handle].Load();
+	if (Current && Current->IsCurrentThread())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RobotStateTelemetry: Subscriber %d cannot unsubscribe from its own callback"), Handle);
+		return;
+	}
+
+	FSubscriber* Subscriber = Subscribers[Handle].Exchange(nullptr);
+	if (!Subscriber) return;
+
+	// The producer may still hold the pointer it loaded before the exchange
+	while (ActivePublishers.Load() > 0)
+	{
+		FPlatformProcess::SleepNoStats(0.0f);
+	}
+	delete Subscriber;
+}
+
+FTelemetrySubscriberStats FRobotStateTelemetry::GetSubscriberStats(int32 Handle) const
+{
+	FTelemetrySubscriberStats Stats;
+	if (Handle >= 0 && Handle < MaxSubscribers)
+	{
+		if (const FSubscriber* Subscriber = Subscribers[Handle].Load())
+		{
+			Stats.Delivered = Subscriber->Delivered.Load();
+			Stats.Dropped = Subscriber->Dropped.Load();
+		}
+	}
+	return Stats;
+}
+
+// ============================================================================
+// Worker-thread subscriber
+// ============================================================================
+
+FRobotStateTelemetry::FSubscriber::FSubscriber(const TCHAR* Name, const TBroadcastRing<FWireRobotState>& InRing, FCallback InCallback)
+	: Ring(InRing)
+	, Callback(MoveTemp(InCallback))
+{
+	Cursor.Position = Ring.GetHead();
+	Event = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, Name, 0, TPri_BelowNormal);
+}
+
+FRobotStateTelemetry::FSubscriber::~FSubscriber()
+{
+	if (Thread)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+	FPlatformProcess::ReturnSynchEventToPool(Event);
+	Event = nullptr;
+}
+
+void FRobotStateTelemetry::FSubscriber::Stop()
+{
+	bStop = true;
+	Event->Trigger();
+}
+
+uint32 FRobotStateTelemetry::FSubscriber::Run()
+{
+	FWireRobotState State;
+	while (!bStop)
+	{
+		// Timeout only bounds how long a missed wake-up can delay delivery
+		Event->Wait(100);
+
+		while (!bStop && Ring.Read(Cursor.Position, State, Cursor.Dropped))
+		{
+			Callback(State);
+			++Delivered;
+		}
+		Dropped = Cursor.Dropped;
+	}
+	return 0;
+}
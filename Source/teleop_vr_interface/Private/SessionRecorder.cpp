@@ -0,0 +1,365 @@
+#include "SessionRecorder.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+#if SESSIONRECORDER_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// Lane: single-producer byte ring
+// ============================================================================
+
+namespace
+{
+	// Entries in a lane are aligned to the record header, so a wrap marker always fits
+	constexpr uint32 LaneAlignment = sizeof(FSessionRecordHeader);
+
+	uint32 LaneEntryBytes(uint32 PayloadSize)
+	{
+		return (sizeof(FSessionRecordHeader) + PayloadSize + LaneAlignment - 1) & ~(LaneAlignment - 1);
+	}
+}
+
+FSessionRecordLane::FSessionRecordLane(uint8 InIndex, int32 InCapacityBytes)
+	: Index(InIndex)
+{
+	Capacity = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(InCapacityBytes, 64 * 1024)));
+	Mask = Capacity - 1;
+	Buffer = MakeUnique<uint8[]>(Capacity);
+}
+
+bool FSessionRecordLane::Record(ERecordDirection Direction, const uint8* Data, int32 Size, double Time)
+{
+	const uint32 EntryBytes = LaneEntryBytes(static_cast<uint32>(FMath::Max(Size, 0)));
+
+	// Entries never wrap, so one must fit even after skipping the end of the buffer
+	if (Size < 0 || EntryBytes > Capacity / 2)
+	{
+		++Dropped;
+		return false;
+	}
+
+	uint64 H = Head.Load(EMemoryOrder::Relaxed);
+	const uint32 Contiguous = Capacity - static_cast<uint32>(H & Mask);
+	const uint32 Skip = Contiguous < EntryBytes ? Contiguous : 0;
+	if (H + Skip + EntryBytes - Tail.Load() > Capacity)
+	{
+		++Dropped;
+		return false;
+	}
+
+	if (Skip > 0)
+	{
+		FSessionRecordHeader* Marker = reinterpret_cast<FSessionRecordHeader*>(Buffer.Get() + (H & Mask));
+		Marker->Size = WrapMarker;
+		H += Skip;
+	}
+
+	FSessionRecordHeader* Header = reinterpret_cast<FSessionRecordHeader*>(Buffer.Get() + (H & Mask));
+	Header->Time = Time;
+	Header->Size = static_cast<uint32>(Size);
+	Header->Direction = static_cast<uint8>(Direction);
+	Header->Lane = Index;
+	Header->Reserved = 0;
+	FMemory::Memcpy(Header + 1, Data, Size);
+
+	Head.Store(H + EntryBytes);
+	++Recorded;
+	return true;
+}
+
+const FSessionRecordHeader* FSessionRecordLane::Peek()
+{
+	for (;;)
+	{
+		const uint64 T = Tail.Load(EMemoryOrder::Relaxed);
+		if (T == Head.Load()) return nullptr;
+
+		const FSessionRecordHeader* Header = reinterpret_cast<const FSessionRecordHeader*>(Buffer.Get() + (T & Mask));
+		if (Header->Size != WrapMarker) return Header;
+
+		Tail.Store(T + (Capacity - static_cast<uint32>(T & Mask)));
+	}
+}
+
+void FSessionRecordLane::Pop()
+{
+	const uint64 T = Tail.Load(EMemoryOrder::Relaxed);
+	const FSessionRecordHeader* Header = reinterpret_cast<const FSessionRecordHeader*>(Buffer.Get() + (T & Mask));
+	Tail.Store(T + LaneEntryBytes(Header->Size));
+}
+
+// ============================================================================
+// Recorder
+// ============================================================================
+
+FSessionRecorder::FSessionRecorder(const FString& InFilePath, int32 InLaneCapacityBytes)
+	: FilePath(InFilePath)
+	, LaneCapacityBytes(InLaneCapacityBytes)
+{
+	ChunkData.Reserve(ChunkBytes);
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+	FSessionFileHeader Header;
+	Header.StartTime = FPlatformTime::Seconds();
+	Header.StartUnixNs = (FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTicks() * 100;
+
+	if (!OpenFile() || !Append(0, reinterpret_cast<const uint8*>(&Header), sizeof(Header)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SessionRecorder: Failed to create %s"), *FilePath);
+		CloseFile();
+		return;
+	}
+	FileSize = sizeof(Header);
+	BytesWritten = FileSize;
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	bRecording = true;
+	Thread = FRunnableThread::Create(this, TEXT("ComLinkRecorder"), 0, TPri_BelowNormal);
+	if (!Thread)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SessionRecorder: Failed to create writer thread"));
+		bRecording = false;
+		CloseFile();
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("SessionRecorder: Recording to %s"), *FilePath);
+}
+
+FSessionRecorder::~FSessionRecorder()
+{
+	Shutdown();
+}
+
+FSessionRecordLane* FSessionRecorder::AddLane()
+{
+	const int32 Index = NumLanes.Load();
+	if (Index >= MaxLanes)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SessionRecorder: All %d lanes in use"), MaxLanes);
+		return nullptr;
+	}
+
+	// Published by the count, so the writer never sees a half-built lane
+	LaneStorage[Index] = MakeUnique<FSessionRecordLane>(static_cast<uint8>(Index), LaneCapacityBytes);
+	NumLanes.Store(Index + 1);
+	return LaneStorage[Index].Get();
+}
+
+void FSessionRecorder::Stop()
+{
+	bStop = true;
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FSessionRecorder::Shutdown()
+{
+	if (Thread)
+	{
+		// The writer drains the lanes once more before it exits
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+
+		UE_LOG(LogTemp, Log, TEXT("SessionRecorder: Wrote %u records (%llu bytes, %u dropped) to %s"),
+			GetRecordedCount(), BytesWritten.Load(), GetDroppedCount(), *FilePath);
+	}
+	bRecording = false;
+	CloseFile();
+
+	if (WakeEvent)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+	}
+}
+
+uint32 FSessionRecorder::GetRecordedCount() const
+{
+	uint32 Count = 0;
+	for (int32 i = 0; i < NumLanes.Load(); ++i)
+	{
+		Count += LaneStorage[i]->GetRecordedCount();
+	}
+	return Count;
+}
+
+uint32 FSessionRecorder::GetDroppedCount() const
+{
+	uint32 Count = 0;
+	for (int32 i = 0; i < NumLanes.Load(); ++i)
+	{
+		Count += LaneStorage[i]->GetDroppedCount();
+	}
+	return Count;
+}
+
+uint32 FSessionRecorder::Run()
+{
+	while (!bStop)
+	{
+		WakeEvent->Wait(static_cast<uint32>(FlushInterval * 1000.0));
+		if (!DrainLanes())
+		{
+			bRecording = false;
+			return 0;
+		}
+	}
+
+	DrainLanes();
+	return 0;
+}
+
+bool FSessionRecorder::DrainLanes()
+{
+	const int32 Count = NumLanes.Load();
+	for (;;)
+	{
+		// Each lane is in time order, so the oldest head across lanes is the next record
+		FSessionRecordLane* OldestLane = nullptr;
+		const FSessionRecordHeader* Oldest = nullptr;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const FSessionRecordHeader* Header = LaneStorage[i]->Peek();
+			if (Header && (!Oldest || Header->Time < Oldest->Time))
+			{
+				OldestLane = LaneStorage[i].Get();
+				Oldest = Header;
+			}
+		}
+		if (!Oldest) break;
+
+		const uint32 DiskBytes = SessionFile::AlignUp(sizeof(FSessionRecordHeader) + Oldest->Size);
+		if (Chunk.RecordCount > 0 && ChunkData.Num() + static_cast<int32>(DiskBytes) > ChunkBytes)
+		{
+			if (!WriteChunk()) return false;
+		}
+
+		const int32 Offset = ChunkData.AddZeroed(DiskBytes);
+		FMemory::Memcpy(ChunkData.GetData() + Offset, Oldest, sizeof(FSessionRecordHeader) + Oldest->Size);
+
+		if (Chunk.RecordCount == 0)
+		{
+			Chunk.FirstTime = Oldest->Time;
+		}
+		Chunk.LastTime = FMath::Max(Chunk.LastTime, Oldest->Time);
+		++Chunk.RecordCount;
+
+		OldestLane->Pop();
+	}
+
+	return Chunk.RecordCount == 0 || WriteChunk();
+}
+
+bool FSessionRecorder::WriteChunk()
+{
+	const uint32 TotalDropped = GetDroppedCount();
+	Chunk.Dropped = TotalDropped - LastDropped;
+	Chunk.PayloadBytes = static_cast<uint32>(ChunkData.Num());
+
+	// Payload first: a valid chunk header marks the chunk as complete
+	if (!Append(FileSize + sizeof(FSessionChunkHeader), ChunkData.GetData(), ChunkData.Num()) ||
+		!Append(FileSize, reinterpret_cast<const uint8*>(&Chunk), sizeof(FSessionChunkHeader)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SessionRecorder: Write to %s failed, recording stopped"), *FilePath);
+		return false;
+	}
+
+	LastDropped = TotalDropped;
+	FileSize += sizeof(FSessionChunkHeader) + ChunkData.Num();
+	BytesWritten = FileSize;
+
+	ChunkData.Reset();
+	Chunk = FSessionChunkHeader();
+	return true;
+}
+
+#if SESSIONRECORDER_MMAP
+
+bool FSessionRecorder::OpenFile()
+{
+	FileDescriptor = open(TCHAR_TO_UTF8(*FilePath), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	return FileDescriptor >= 0;
+}
+
+void FSessionRecorder::CloseFile()
+{
+	if (MappedWindow)
+	{
+		munmap(MappedWindow, WindowSize);
+		MappedWindow = nullptr;
+	}
+	if (FileDescriptor >= 0)
+	{
+		// The file grows a window at a time; drop the unused tail
+		if (ftruncate(FileDescriptor, static_cast<off_t>(FileSize)) != 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SessionRecorder: Failed to trim %s"), *FilePath);
+		}
+		close(FileDescriptor);
+		FileDescriptor = -1;
+	}
+}
+
+bool FSessionRecorder::Append(uint64 Offset, const uint8* Data, int32 Size)
+{
+	if (Offset < WindowOffset || Offset + Size > WindowOffset + WindowSize || !MappedWindow)
+	{
+		if (MappedWindow)
+		{
+			munmap(MappedWindow, WindowSize);
+			MappedWindow = nullptr;
+		}
+
+		// Slide the window to the page holding Offset, keeping the previous page
+		// mapped as well so a chunk header written after its payload does not remap
+		const uint64 PageSize = static_cast<uint64>(sysconf(_SC_PAGESIZE));
+		const uint64 Start = Offset & ~(PageSize - 1);
+		WindowOffset = Start >= PageSize ? Start - PageSize : 0;
+		WindowSize = FMath::Max(MapWindowBytes, Align(Offset + Size - WindowOffset, PageSize));
+
+		if (WindowOffset + WindowSize > MappedFileSize)
+		{
+			if (ftruncate(FileDescriptor, static_cast<off_t>(WindowOffset + WindowSize)) != 0) return false;
+			MappedFileSize = WindowOffset + WindowSize;
+		}
+
+		void* Mapping = mmap(nullptr, WindowSize, PROT_READ | PROT_WRITE, MAP_SHARED, FileDescriptor, static_cast<off_t>(WindowOffset));
+		if (Mapping == MAP_FAILED) return false;
+		MappedWindow = static_cast<uint8*>(Mapping);
+	}
+
+	FMemory::Memcpy(MappedWindow + (Offset - WindowOffset), Data, Size);
+	return true;
+}
+
+#else
+
+bool FSessionRecorder::OpenFile()
+{
+	FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FilePath, false, true));
+	return FileHandle.IsValid();
+}
+
+void FSessionRecorder::CloseFile()
+{
+	FileHandle.Reset();
+}
+
+bool FSessionRecorder::Append(uint64 Offset, const uint8* Data, int32 Size)
+{
+	return FileHandle->Seek(static_cast<int64>(Offset)) && FileHandle->Write(Data, Size);
+}
+
+#endif
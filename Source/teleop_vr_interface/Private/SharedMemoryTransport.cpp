@@ -0,0 +1,493 @@
+#include "SharedMemoryTransport.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "SessionRecorder.h"
+
+#if SHAREDMEMORYTRANSPORT_AVAILABLE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <climits>
+#endif
+
+namespace
+{
+	/** Bytes before the first ring: segment header and both ring controls */
+	constexpr uint64 ControlAreaBytes = sizeof(FShmSegmentHeader) + ShmSegment::NumRings * sizeof(FShmRingControl);
+
+	/** How long to wait for the other side to finish initializing a segment it just created */
+	constexpr double AttachTimeoutSeconds = 2.0;
+
+	constexpr uint32 MinRingBytes = 64 * 1024;
+	constexpr uint32 MaxRingBytes = 1u << 30;	// RingBytes is a uint32 power of two
+}
+
+FSharedMemoryTransport::FSharedMemoryTransport(const FString& InName, SIZE_T InRingBytes)
+	: Name(InName)
+	, RequestedRingBytes(InRingBytes)
+{
+	SendBatchData.Reserve(MaxSendBatch * 128);
+
+	// On a single core, spinning only keeps the simulator from producing
+	SpinSeconds = FPlatformMisc::NumberOfCoresIncludingHyperthreads() > 1 ? SpinBeforeWaitSeconds : 0.0;
+
+	if (!OpenSegment())
+	{
+		CloseSegment();
+		return;
+	}
+
+	ReceiverThread = FRunnableThread::Create(this, TEXT("ShmRecvThread"), 0, TPri_Normal);
+	UE_LOG(LogTemp, Log, TEXT("SharedMemoryTransport: Attached to /dev/shm/%s (%u KB per direction)"), *Name, RingBytes / 1024);
+}
+
+FSharedMemoryTransport::~FSharedMemoryTransport()
+{
+	stop();
+}
+
+void FSharedMemoryTransport::stop()
+{
+	if (ReceiverThread)
+	{
+		Stop();
+		ReceiverThread->WaitForCompletion();
+		delete ReceiverThread;
+		ReceiverThread = nullptr;
+	}
+
+	if (Segment)
+	{
+		CloseSegment();
+		UE_LOG(LogTemp, Log, TEXT("SharedMemoryTransport: Stopped (%u datagrams dropped on a full ring)"), SendOverflows.Load());
+	}
+}
+
+// ============================================================================
+// Segment setup  platform specific
+// ============================================================================
+
+#if SHAREDMEMORYTRANSPORT_AVAILABLE
+
+bool FSharedMemoryTransport::OpenSegment()
+{
+	if (Name.IsEmpty() || Name.Contains(TEXT("/")))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: Invalid segment name '%s'"), *Name);
+		return false;
+	}
+
+	const FTCHARToUTF8 Path(*(TEXT("/") + Name));
+
+	// Whoever creates the segment sizes and initializes it; the other side attaches
+	int Fd = shm_open(Path.Get(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	const bool bCreated = Fd >= 0;
+	if (!bCreated && errno == EEXIST)
+	{
+		Fd = shm_open(Path.Get(), O_RDWR, 0);
+	}
+	if (Fd < 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: Failed to open /dev/shm/%s (errno %d)"), *Name, errno);
+		return false;
+	}
+
+	if (bCreated)
+	{
+		const SIZE_T Requested = FMath::Clamp<SIZE_T>(RequestedRingBytes, MinRingBytes, MaxRingBytes);
+		RingBytes = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(Requested));
+		SegmentBytes = ControlAreaBytes + ShmSegment::NumRings * static_cast<uint64>(RingBytes);
+
+		// ftruncate zero-fills, which is the initial state of both rings
+		if (ftruncate(Fd, static_cast<off_t>(SegmentBytes)) != 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: Failed to size /dev/shm/%s (errno %d)"), *Name, errno);
+			shm_unlink(Path.Get());
+			close(Fd);
+			return false;
+		}
+	}
+	else
+	{
+		// Wait for the creator to size the segment and publish its header
+		const double Deadline = FPlatformTime::Seconds() + AttachTimeoutSeconds;
+		for (;;)
+		{
+			struct stat Info;
+			if (fstat(Fd, &Info) == 0 && static_cast<uint64>(Info.st_size) >= ControlAreaBytes)
+			{
+				void* Header = mmap(nullptr, sizeof(FShmSegmentHeader), PROT_READ, MAP_SHARED, Fd, 0);
+				if (Header != MAP_FAILED)
+				{
+					const FShmSegmentHeader* SegmentHeader = static_cast<const FShmSegmentHeader*>(Header);
+					const bool bReady = FPlatformAtomics::AtomicRead(reinterpret_cast<const volatile int32*>(&SegmentHeader->Magic)) ==
+						static_cast<int32>(ShmSegment::Magic);
+					const uint32 Version = SegmentHeader->Version;
+					RingBytes = SegmentHeader->RingBytes;
+					munmap(Header, sizeof(FShmSegmentHeader));
+
+					if (bReady)
+					{
+						if (Version != ShmSegment::Version || !FMath::IsPowerOfTwo(RingBytes) || RingBytes < MinRingBytes || RingBytes > MaxRingBytes)
+						{
+							UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: /dev/shm/%s is not a version %u segment; delete it to start over"),
+								*Name, ShmSegment::Version);
+							close(Fd);
+							return false;
+						}
+						SegmentBytes = ControlAreaBytes + ShmSegment::NumRings * static_cast<uint64>(RingBytes);
+						if (static_cast<uint64>(Info.st_size) >= SegmentBytes) break;
+					}
+				}
+			}
+
+			if (FPlatformTime::Seconds() > Deadline)
+			{
+				UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: /dev/shm/%s was never initialized; delete it to start over"), *Name);
+				close(Fd);
+				return false;
+			}
+			FPlatformProcess::SleepNoStats(0.001f);
+		}
+	}
+
+	void* Mapping = mmap(nullptr, SegmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+	close(Fd);	// the mapping keeps the segment alive
+	if (Mapping == MAP_FAILED)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: Failed to map /dev/shm/%s (errno %d)"), *Name, errno);
+		if (bCreated)
+		{
+			// Never initialized, so the other side would wait on it until its timeout
+			shm_unlink(Path.Get());
+		}
+		return false;
+	}
+
+	Segment = static_cast<uint8*>(Mapping);
+	Controls = reinterpret_cast<FShmRingControl*>(Segment + sizeof(FShmSegmentHeader));
+	for (int32 Ring = 0; Ring < ShmSegment::NumRings; ++Ring)
+	{
+		RingData[Ring] = Segment + ControlAreaBytes + Ring * static_cast<uint64>(RingBytes);
+	}
+
+	if (bCreated)
+	{
+		FShmSegmentHeader* Header = reinterpret_cast<FShmSegmentHeader*>(Segment);
+		Header->Version = ShmSegment::Version;
+		Header->RingBytes = RingBytes;
+		Header->MaxDatagramBytes = MaxDatagramBytes;
+
+		// Magic last: the other side treats the segment as initialized once it sees it
+		FPlatformAtomics::AtomicStore(reinterpret_cast<volatile int32*>(&Header->Magic), static_cast<int32>(ShmSegment::Magic));
+	}
+	return true;
+}
+
+void FSharedMemoryTransport::CloseSegment()
+{
+	if (Segment)
+	{
+		munmap(Segment, SegmentBytes);
+	}
+	Segment = nullptr;
+	Controls = nullptr;
+	RingData[0] = RingData[1] = nullptr;
+}
+
+void FSharedMemoryTransport::Wake(FShmRingControl& Control)
+{
+	FPlatformAtomics::InterlockedIncrement(&Control.Signal);
+	if (FPlatformAtomics::AtomicRead(&Control.Waiters) > 0)
+	{
+		// Not FUTEX_PRIVATE: the waiter is in another process
+		syscall(SYS_futex, &Control.Signal, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+	}
+}
+
+void FSharedMemoryTransport::WaitForData()
+{
+	FShmRingControl& Control = Controls[ShmSegment::ToOperator];
+
+	const double SpinEnd = FPlatformTime::Seconds() + SpinSeconds;
+	while (FPlatformTime::Seconds() < SpinEnd)
+	{
+		if (bStop || FPlatformAtomics::AtomicRead(&Control.Head) != Control.Tail) return;
+		FPlatformProcess::Yield();
+	}
+
+	// Register as a waiter before the final check, so a publish either is seen
+	// here or sees the waiter and wakes us
+	const int32 Seen = FPlatformAtomics::AtomicRead(&Control.Signal);
+	FPlatformAtomics::InterlockedIncrement(&Control.Waiters);
+	if (!bStop && FPlatformAtomics::AtomicRead(&Control.Head) == Control.Tail)
+	{
+		timespec Timeout;
+		Timeout.tv_sec = WaitTimeoutMs / 1000;
+		Timeout.tv_nsec = (WaitTimeoutMs % 1000) * 1000000L;
+		syscall(SYS_futex, &Control.Signal, FUTEX_WAIT, Seen, &Timeout, nullptr, 0);
+	}
+	FPlatformAtomics::InterlockedDecrement(&Control.Waiters);
+}
+
+#else
+
+bool FSharedMemoryTransport::OpenSegment()
+{
+	UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: Not supported on this platform, use a UDP address"));
+	return false;
+}
+
+void FSharedMemoryTransport::CloseSegment()
+{
+	Segment = nullptr;
+	Controls = nullptr;
+	RingData[0] = RingData[1] = nullptr;
+}
+
+void FSharedMemoryTransport::Wake(FShmRingControl& Control)
+{
+}
+
+void FSharedMemoryTransport::WaitForData()
+{
+}
+
+#endif
+
+// ============================================================================
+// Receive thread
+// ============================================================================
+
+uint32 FSharedMemoryTransport::Run()
+{
+	while (!bStop)
+	{
+		if (!ReadAvailable())
+		{
+			WaitForData();
+		}
+	}
+	return 0;
+}
+
+void FSharedMemoryTransport::Stop()
+{
+	bStop = true;
+	if (Controls)
+	{
+		Wake(Controls[ShmSegment::ToOperator]);
+	}
+}
+
+bool FSharedMemoryTransport::ReadAvailable()
+{
+	FShmRingControl& Control = Controls[ShmSegment::ToOperator];
+	const uint8* Ring = RingData[ShmSegment::ToOperator];
+	const uint64 Mask = RingBytes - 1;
+
+	int64 Tail = Control.Tail;
+	const int64 Head = FPlatformAtomics::AtomicRead(&Control.Head);
+	if (Tail == Head) return false;
+
+	const double Now = FPlatformTime::Seconds();
+	while (Tail < Head)
+	{
+		const uint64 Offset = static_cast<uint64>(Tail) & Mask;
+		const uint32 Size = *reinterpret_cast<const uint32*>(Ring + Offset);
+		if (Size == ShmSegment::WrapMarker)
+		{
+			Tail += RingBytes - Offset;
+			continue;
+		}
+		if (Size > static_cast<uint32>(MaxDatagramBytes) || Offset + ShmSegment::RecordHeaderBytes + Size > RingBytes)
+		{
+			UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: Corrupt datagram at offset %llu, discarding %lld bytes"),
+				Offset, Head - Tail);
+			Tail = Head;
+			break;
+		}
+
+		// Dispatched in place: the slot is only released when Tail is published below
+		const uint8* Payload = Ring + Offset + ShmSegment::RecordHeaderBytes;
+		if (bRecording)
+		{
+			RecvRecordLane->Record(ERecordDirection::Inbound, Payload, static_cast<int32>(Size), Now);
+		}
+		Demux.Dispatch(Payload, static_cast<int32>(Size), Now);
+
+		Tail += ShmSegment::RecordHeaderBytes + ShmSegment::AlignUp(Size);
+	}
+
+	FPlatformAtomics::AtomicStore(&Control.Tail, Tail);
+	LastReceiveTime = Now;
+	return true;
+}
+
+// ============================================================================
+// Send
+// ============================================================================
+
+bool FSharedMemoryTransport::send_raw(const uint8* Data, int32 Size)
+{
+	if (!Segment) return false;
+
+	if (bRecording)
+	{
+		Record(SendRecordLane, Data, &Size, 1);
+	}
+	FScopeLock Lock(&SendLock);
+	return Write(Data, &Size, 1);
+}
+
+void FSharedMemoryTransport::queue_send(const uint8* Data, int32 Size)
+{
+	if (SendBatchSizes.Num() >= MaxSendBatch)
+	{
+		flush_sends();
+	}
+	SendBatchData.Append(Data, Size);
+	SendBatchSizes.Add(Size);
+}
+
+bool FSharedMemoryTransport::flush_sends()
+{
+	const int32 NumQueued = SendBatchSizes.Num();
+	if (NumQueued == 0) return true;
+
+	bool bSuccess = false;
+	if (Segment)
+	{
+		if (bRecording)
+		{
+			Record(SendRecordLane, SendBatchData.GetData(), SendBatchSizes.GetData(), NumQueued);
+		}
+		FScopeLock Lock(&SendLock);
+		bSuccess = Write(SendBatchData.GetData(), SendBatchSizes.GetData(), NumQueued);
+	}
+
+	SendBatchData.Reset();
+	SendBatchSizes.Reset();
+	return bSuccess;
+}
+
+bool FSharedMemoryTransport::send_batch(const uint8* Data, const int32* Sizes, int32 Count)
+{
+	if (Count <= 0) return true;
+	if (!Segment) return false;
+
+	if (bRecording)
+	{
+		Record(BatchRecordLane, Data, Sizes, Count);
+	}
+	FScopeLock Lock(&SendLock);
+	return Write(Data, Sizes, Count);
+}
+
+bool FSharedMemoryTransport::Write(const uint8* Data, const int32* Sizes, int32 Count)
+{
+	FShmRingControl& Control = Controls[ShmSegment::ToSimulator];
+	uint8* Ring = RingData[ShmSegment::ToSimulator];
+	const uint64 Mask = RingBytes - 1;
+
+	int64 Head = Control.Head;
+	int64 Tail = FPlatformAtomics::AtomicRead(&Control.Tail);
+	bool bSuccess = true;
+	int32 NumWritten = 0;
+
+	int32 DataOffset = 0;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		const int32 Size = Sizes[i];
+		const uint8* Payload = Data + DataOffset;
+		DataOffset += Size;
+
+		if (Size <= 0 || Size > MaxDatagramBytes)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SharedMemoryTransport: Datagram of %d bytes not sent"), Size);
+			bSuccess = false;
+			continue;
+		}
+
+		// A datagram that does not fit before the end of the ring starts over at the beginning
+		const uint32 Needed = ShmSegment::RecordHeaderBytes + ShmSegment::AlignUp(static_cast<uint32>(Size));
+		const uint64 Offset = static_cast<uint64>(Head) & Mask;
+		const uint32 Padding = RingBytes - Offset < Needed ? static_cast<uint32>(RingBytes - Offset) : 0;
+
+		if (Head + Padding + Needed - Tail > RingBytes)
+		{
+			Tail = FPlatformAtomics::AtomicRead(&Control.Tail);
+			if (Head + Padding + Needed - Tail > RingBytes)
+			{
+				// Full ring: drop like a full socket buffer would, the simulator is not keeping up
+				++SendOverflows;
+				bSuccess = false;
+				continue;
+			}
+		}
+
+		if (Padding > 0)
+		{
+			*reinterpret_cast<uint32*>(Ring + Offset) = ShmSegment::WrapMarker;
+			Head += Padding;
+		}
+
+		uint8* Slot = Ring + (static_cast<uint64>(Head) & Mask);
+		*reinterpret_cast<uint32*>(Slot) = static_cast<uint32>(Size);
+		FMemory::Memcpy(Slot + ShmSegment::RecordHeaderBytes, Payload, Size);
+		Head += Needed;
+		++NumWritten;
+	}
+
+	// One publish and at most one wake-up per batch
+	if (NumWritten > 0)
+	{
+		FPlatformAtomics::AtomicStore(&Control.Head, Head);
+		Wake(Control);
+	}
+	return bSuccess;
+}
+
+void FSharedMemoryTransport::Record(FSessionRecordLane* Lane, const uint8* Data, const int32* Sizes, int32 Count)
+{
+	const double Now = FPlatformTime::Seconds();
+	int32 Offset = 0;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Lane->Record(ERecordDirection::Outbound, Data + Offset, Sizes[i], Now);
+		Offset += Sizes[i];
+	}
+}
+
+// ============================================================================
+// Recording and connection health
+// ============================================================================
+
+void FSharedMemoryTransport::set_recorder(FSessionRecorder* Recorder)
+{
+	if (bRecording || !Recorder)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: Recorder already set or null"));
+		return;
+	}
+
+	RecvRecordLane = Recorder->AddLane();
+	SendRecordLane = Recorder->AddLane();
+	BatchRecordLane = Recorder->AddLane();
+	if (!RecvRecordLane || !SendRecordLane || !BatchRecordLane)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SharedMemoryTransport: Not enough recorder lanes"));
+		return;
+	}
+
+	bRecording = true;
+}
+
+bool FSharedMemoryTransport::isConnectionAlive() const
+{
+	return (FPlatformTime::Seconds() - LastReceiveTime.Load()) < 1.5;
+}
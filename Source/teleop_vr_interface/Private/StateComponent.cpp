@@ -72,6 +72,9 @@ void UStateComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActor
 	{
 		ComLinkRef->SendHeadPose(HeadPose);
 	}
+
+	// This frame's poses leave in one batch, or go to the pose sender thread
+	ComLinkRef->FlushSends();
 }
 
 // ============================================================================
@@ -0,0 +1,152 @@
+#include "StreamStats.h"
+
+const float FSequenceTracker::HistogramEdgesMs[NumHistogramBuckets - 1] = { 1.f, 2.f, 5.f, 10.f, 20.f, 50.f, 100.f, 200.f, 500.f };
+
+FSequenceTracker::EVerdict FSequenceTracker::Observe(uint32 Sequence, double ReceiveTime, uint32 LocalDrops)
+{
+	PendingLocalDrops += LocalDrops - LastLocalDrops;
+	LastLocalDrops = LocalDrops;
+
+	if (!bStarted)
+	{
+		bStarted = true;
+		Resync(Sequence);
+		++Stats.Received;
+		RecordArrival(ReceiveTime);
+		return EVerdict::Accept;
+	}
+
+	// Serial-number arithmetic, so wrap-around at 2^32 is just another step forward
+	const int32 Diff = static_cast<int32>(Sequence - Highest);
+
+	if (Diff > 0)
+	{
+		const uint32 Gap = static_cast<uint32>(Diff - 1);
+		LostMask = (Diff >= 64) ? 0 : (LostMask << Diff);
+		if (Gap > 0)
+		{
+			// Gaps explained by packets the mailbox superseded are not network loss
+			const uint32 Absorbed = FMath::Min(Gap, PendingLocalDrops);
+			const uint32 Missing = Gap - Absorbed;
+			PendingLocalDrops -= Absorbed;
+
+			++Stats.Gaps;
+			Stats.MaxGap = FMath::Max(Stats.MaxGap, static_cast<int32>(FMath::Min<uint32>(Gap, MAX_int32)));
+			Stats.Superseded += Absorbed;
+			Stats.Lost += Missing;
+
+			// The superseded packets were the newest of the gap; remember which older
+			// ones were counted as lost so a late copy can take exactly those back
+			const int32 OldestLostAge = Diff - static_cast<int32>(Missing);
+			if (Missing > 0 && OldestLostAge < 64)
+			{
+				const int32 NewestLostAge = FMath::Min(Diff - 1, 63);
+				LostMask |= ((1ull << (NewestLostAge - OldestLostAge + 1)) - 1) << OldestLostAge;
+			}
+			RecentLoss = 1.0 - (1.0 - RecentLoss) * FMath::Pow(1.0 - RecentLossAlpha, static_cast<double>(Missing));
+		}
+
+		ReceivedMask = (Diff >= 64) ? 1 : ((ReceivedMask << Diff) | 1);
+		Highest = Sequence;
+		ConsecutiveStale = 0;
+
+		++Stats.Received;
+		RecentLoss *= 1.0 - RecentLossAlpha;
+		RecordArrival(ReceiveTime);
+	}
+	else
+	{
+		const uint32 Age = Highest - Sequence;
+		if (Age >= ReorderWindow)
+		{
+			// A run of very old sequence numbers means the remote started counting again
+			if (++ConsecutiveStale >= ResyncAfterStale)
+			{
+				UE_LOG(LogTemp, Log, TEXT("ComLink: Sequence restarted at %u (was %u)"), Sequence, Highest);
+				++Stats.Resyncs;
+				Resync(Sequence);
+				++Stats.Received;
+				RecordArrival(ReceiveTime);
+				return EVerdict::Accept;
+			}
+			++Stats.Reordered;
+			return EVerdict::Stale;
+		}
+
+		ConsecutiveStale = 0;
+		const uint64 Bit = 1ull << Age;
+		if (ReceivedMask & Bit)
+		{
+			++Stats.Duplicates;
+			return EVerdict::Duplicate;
+		}
+
+		// Late arrival fills a gap, but a newer packet is already out. Only gaps counted
+		// as lost are taken back; superseded ones were never added to Lost.
+		ReceivedMask |= Bit;
+		++Stats.Reordered;
+		if (LostMask & Bit)
+		{
+			LostMask &= ~Bit;
+			--Stats.Lost;
+		}
+		UpdateLoss();
+		return EVerdict::Stale;
+	}
+
+	UpdateLoss();
+	return EVerdict::Accept;
+}
+
+void FSequenceTracker::UpdateLoss()
+{
+	const int32 Expected = Stats.Received + Stats.Reordered + Stats.Lost + Stats.Superseded;
+	Stats.LossPercent = Expected > 0 ? 100.0f * Stats.Lost / Expected : 0.0f;
+	Stats.RecentLossPercent = static_cast<float>(100.0 * RecentLoss);
+}
+
+void FSequenceTracker::RecordArrival(double ReceiveTime)
+{
+	if (LastArrival >= 0.0)
+	{
+		const float DeltaMs = static_cast<float>((ReceiveTime - LastArrival) * 1000.0);
+
+		if (Stats.MeanInterArrivalMs <= 0.0f)
+		{
+			Stats.MeanInterArrivalMs = DeltaMs;
+		}
+		Stats.MeanInterArrivalMs += (DeltaMs - Stats.MeanInterArrivalMs) / 16.0f;
+		Stats.InterArrivalJitterMs += (FMath::Abs(DeltaMs - Stats.MeanInterArrivalMs) - Stats.InterArrivalJitterMs) / 16.0f;
+		Stats.MaxInterArrivalMs = FMath::Max(Stats.MaxInterArrivalMs, DeltaMs);
+
+		int32 Bucket = 0;
+		while (Bucket < NumHistogramBuckets - 1 && DeltaMs >= HistogramEdgesMs[Bucket]) ++Bucket;
+		++Stats.InterArrivalHistogram[Bucket];
+	}
+	LastArrival = ReceiveTime;
+}
+
+void FSequenceTracker::Resync(uint32 Sequence)
+{
+	Highest = Sequence;
+	ReceivedMask = 1;
+	LostMask = 0;
+	ConsecutiveStale = 0;
+	PendingLocalDrops = 0;
+}
+
+void FSequenceTracker::Reset()
+{
+	// LastLocalDrops is a running total owned by the socket and stays in step
+	Stats = FComStreamStats();
+	Stats.InterArrivalHistogram.SetNumZeroed(NumHistogramBuckets);
+
+	bStarted = false;
+	Highest = 0;
+	ReceivedMask = 0;
+	LostMask = 0;
+	ConsecutiveStale = 0;
+	PendingLocalDrops = 0;
+	LastArrival = -1.0;
+	RecentLoss = 0.0;
+}
@@ -4,7 +4,7 @@
 #include "Components/StaticMeshComponent.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Engine/StaticMesh.h"
-#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
 #include "UObject/ConstructorHelpers.h"
 #include "GameFramework/Actor.h"
 
@@ -71,10 +71,10 @@ void UVideoFeedComponent::TickComponent(float DeltaTime, ELevelTick TickType, FA
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	if (!ActiveSource || !VideoTexture) return;
+	if (!ActiveSource || !VideoTarget) return;
 
 	// Just update texture, skip auto-resize for now
-	ActiveSource->UpdateTexture(VideoTexture);
+	ActiveSource->UpdateTexture(VideoTarget);
 }
 */
 
@@ -83,7 +83,10 @@ void UVideoFeedComponent::TickComponent(float DeltaTime, ELevelTick TickType, FA
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	if (!ActiveSource || !VideoTexture) return;
+	if (!ActiveSource || !VideoTarget) return;
+
+	// Pull latest frame into the target (the source resizes it to the frame)
+	ActiveSource->UpdateTexture(VideoTarget);
 
 	// Check if source dimensions changed (auto-detect resolution)
 	int32 SrcWidth, SrcHeight;
@@ -91,13 +94,13 @@ void UVideoFeedComponent::TickComponent(float DeltaTime, ELevelTick TickType, FA
 	{
 		if (SrcWidth != CurrentTextureWidth || SrcHeight != CurrentTextureHeight)
 		{
-			EnsureTextureSize(SrcWidth, SrcHeight);
+			UE_LOG(LogTemp, Log, TEXT("VideoFeed: Resolution %dx%d -> %dx%d"),
+				CurrentTextureWidth, CurrentTextureHeight, SrcWidth, SrcHeight);
+			CurrentTextureWidth = SrcWidth;
+			CurrentTextureHeight = SrcHeight;
 			UpdatePlaneScale(SrcWidth, SrcHeight);
 		}
 	}
-
-	// Pull latest frame into texture
-	ActiveSource->UpdateTexture(VideoTexture);
 }
 
 
@@ -209,22 +212,20 @@ void UVideoFeedComponent::CreateDisplayPlane()
 
 	DisplayPlane->RegisterComponent();
 
-	// Create default texture (will be resized on first frame)
-	VideoTexture = UTexture2D::CreateTransient(1280, 720, PF_B8G8R8A8);
-	if (VideoTexture)
-	{
-		VideoTexture->SRGB = true;
-		VideoTexture->UpdateResource();
-		CurrentTextureWidth = 1280;
-		CurrentTextureHeight = 720;
-	}
+	// Create the video target. Its surface is allocated at the first frame's size,
+	// until then the material samples the engine's default texture.
+	// RTF_RGBA8_SRGB is B8G8R8A8 sampled with sRGB decode, like the decoded frames.
+	VideoTarget = NewObject<UTextureRenderTarget2D>(this, TEXT("VideoTarget"));
+	VideoTarget->RenderTargetFormat = RTF_RGBA8_SRGB;
+	VideoTarget->ClearColor = FLinearColor::Black;
+	VideoTarget->bAutoGenerateMips = false;
 
 	// Create dynamic material
 	UMaterial* BaseMat = LoadObject<UMaterial>(nullptr, TEXT("/Game/Materials/M_VideoFeed.M_VideoFeed"));
 	if (BaseMat)
 	{
 		DynamicMaterial = UMaterialInstanceDynamic::Create(BaseMat, Owner);
-		DynamicMaterial->SetTextureParameterValue(FName("VideoTexture"), VideoTexture);
+		DynamicMaterial->SetTextureParameterValue(FName("VideoTexture"), VideoTarget);
 		DisplayPlane->SetMaterial(0, DynamicMaterial);
 	}
 	else
@@ -251,29 +252,3 @@ void UVideoFeedComponent::UpdatePlaneScale(int32 Width, int32 Height)
 
 	DisplayPlane->SetRelativeScale3D(FVector(ScaleX, ScaleY, 1.0f));
 }
-
-void UVideoFeedComponent::EnsureTextureSize(int32 Width, int32 Height)
-{
-	if (Width == CurrentTextureWidth && Height == CurrentTextureHeight) return;
-	if (Width <= 0 || Height <= 0) return;
-
-	UE_LOG(LogTemp, Log, TEXT("VideoFeed: Resizing texture %dx%d -> %dx%d"),
-		CurrentTextureWidth, CurrentTextureHeight, Width, Height);
-
-	// Create new texture at the right size
-	UTexture2D* NewTexture = UTexture2D::CreateTransient(Width, Height, PF_B8G8R8A8);
-	if (!NewTexture) return;
-
-	NewTexture->SRGB = true;
-	NewTexture->UpdateResource();
-
-	// Update material reference
-	if (DynamicMaterial)
-	{
-		DynamicMaterial->SetTextureParameterValue(FName("VideoTexture"), NewTexture);
-	}
-
-	VideoTexture = NewTexture;
-	CurrentTextureWidth = Width;
-	CurrentTextureHeight = Height;
-}
@@ -1,16 +1,28 @@
 #include "udpClient.h"
 #include "HAL/PlatformTime.h"
+#include "SessionRecorder.h"
+
+#if UDPCLIENT_NATIVE_BATCHING
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <net/if.h>
+#include <time.h>
+#endif
 
 udpClient::udpClient()
 	: Socket(nullptr)
 	, BufferSize(4096)
 {
 	SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
-	bNewData = false;
-	sender_time = 0;
 }
 
-udpClient::udpClient(FString ip_address, bool send_enabled, int32 sPort, bool receive_enabled, int32 rPort)
+udpClient::udpClient(FString ip_address, bool send_enabled, int32 sPort, bool receive_enabled, int32 rPort,
+	const FUdpSocketOptions& InOptions)
 	: Socket(nullptr)
 	, BufferSize(4096)
 	, bWriteIsEnabled(send_enabled)
@@ -18,65 +30,315 @@ udpClient::udpClient(FString ip_address, bool send_enabled, int32 sPort, bool re
 	, ip(ip_address)
 	, sendPort(sPort)
 	, receivePort(rPort)
+	, Options(InOptions)
 {
 	SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	SendBatchData.Reserve(MaxSendBatch * 128);
 
-	Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("UdpClientSocket"), false);
-	if (!Socket)
+	if (!open_socket())
 	{
-		UE_LOG(LogTemp, Error, TEXT("udpClient: Failed to create UDP socket."));
+		stop();
 		return;
 	}
-	Socket->SetReuseAddr(true);
-	Socket->SetRecvErr(true);
-	Socket->SetNonBlocking(true);
+
+	if (bReceiveIsEnabled)
+	{
+		ReceiverThread = FRunnableThread::Create(this, TEXT("UDPRecvThread"), 0, TPri_Normal);
+
+		if (bWriteIsEnabled)
+		{
+			UE_LOG(LogTemp, Log, TEXT("udpClient: send to %s:%d, receive on :%d"), *ip_address, sPort, rPort);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("udpClient: receive-only on :%d"), rPort);
+		}
+	}
+}
+
+udpClient::~udpClient()
+{
+	stop();
+}
+
+#if UDPCLIENT_NATIVE_BATCHING
+
+bool udpClient::open_socket()
+{
+	bNativeIPv6 = Options.bIPv6 || ip.Contains(TEXT(":")) || Options.MulticastGroup.Contains(TEXT(":"));
+
+	NativeSocket = socket(bNativeIPv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, 0);
+	if (NativeSocket < 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("udpClient: Failed to create UDP socket."));
+		return false;
+	}
+	int One = 1;
+	setsockopt(NativeSocket, SOL_SOCKET, SO_REUSEADDR, &One, sizeof(One));
+	fcntl(NativeSocket, F_SETFL, fcntl(NativeSocket, F_GETFL, 0) | O_NONBLOCK);
+
+	if (bNativeIPv6)
+	{
+		// Dual stack: IPv4 peers are reached and received as v4-mapped addresses
+		int Zero = 0;
+		setsockopt(NativeSocket, IPPROTO_IPV6, IPV6_V6ONLY, &Zero, sizeof(Zero));
+	}
 
 	// Initialize remote address for sending
 	if (bWriteIsEnabled)
 	{
-		RemoteAddr = SocketSubsystem->CreateInternetAddr();
-		bool bIsValidIp = false;
-		RemoteAddr->SetIp(*ip_address, bIsValidIp);
-		RemoteAddr->SetPort(sPort);
-
-		if (!bIsValidIp)
+		if (!resolve_native(ip, sendPort, NativeRemotes[0]))
 		{
-			UE_LOG(LogTemp, Error, TEXT("udpClient: Invalid IP address: %s"), *ip_address);
-			stop();
-			return;
+			UE_LOG(LogTemp, Error, TEXT("udpClient: Invalid IP address: %s"), *ip);
+			return false;
+		}
+		// Every endpoint starts out at the primary address
+		for (int32 Endpoint = 1; Endpoint < FPacketDemux::MaxEndpoints; ++Endpoint)
+		{
+			NativeRemotes[Endpoint] = NativeRemotes[0];
 		}
 	}
 
 	if (bReceiveIsEnabled)
 	{
-		LocalAddr = SocketSubsystem->CreateInternetAddr();
-		LocalAddr->SetAnyAddress();
-		LocalAddr->SetPort(rPort);
+		FNativeAddress Local;
+		resolve_native(bNativeIPv6 ? TEXT("::") : TEXT("0.0.0.0"), receivePort, Local);
 
-		if (!Socket->Bind(*LocalAddr))
+		if (bind(NativeSocket, reinterpret_cast<const sockaddr*>(Local.Storage), Local.Length) != 0)
 		{
-			UE_LOG(LogTemp, Error, TEXT("udpClient: Failed to bind socket to port %d"), rPort);
-			stop();
-			return;
+			UE_LOG(LogTemp, Error, TEXT("udpClient: Failed to bind socket to port %d"), receivePort);
+			return false;
 		}
-		ReceiveBuffer.SetNumUninitialized(BufferSize);
-		ReceiverThread = FRunnableThread::Create(this, TEXT("UDPRecvThread"), 0, TPri_Normal);
+	}
 
-		if (bWriteIsEnabled)
+	apply_socket_options();
+
+	// Stamp datagrams as they come off the wire, so latency and jitter exclude
+	// the time until the receive thread is scheduled and drains the socket
+	bKernelTimestamps = bReceiveIsEnabled && setsockopt(NativeSocket, SOL_SOCKET, SO_TIMESTAMPNS, &One, sizeof(One)) == 0;
+	if (bReceiveIsEnabled && !bKernelTimestamps)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("udpClient: Kernel receive timestamps unavailable (errno %d), using receive thread time"), errno);
+	}
+	return true;
+}
+
+bool udpClient::resolve_native(const FString& Ip, int32 Port, FNativeAddress& Out) const
+{
+	static_assert(sizeof(sockaddr_in6) <= sizeof(Out.Storage), "Native address storage too small");
+	Out = FNativeAddress();
+	const FString Address = (bNativeIPv6 && !Ip.Contains(TEXT(":"))) ? TEXT("::ffff:") + Ip : Ip;
+
+	if (bNativeIPv6)
+	{
+		sockaddr_in6* Addr = reinterpret_cast<sockaddr_in6*>(Out.Storage);
+		Addr->sin6_family = AF_INET6;
+		Addr->sin6_port = htons(static_cast<uint16>(Port));
+		if (inet_pton(AF_INET6, TCHAR_TO_ANSI(*Address), &Addr->sin6_addr) != 1) return false;
+		Out.Length = sizeof(sockaddr_in6);
+	}
+	else
+	{
+		sockaddr_in* Addr = reinterpret_cast<sockaddr_in*>(Out.Storage);
+		Addr->sin_family = AF_INET;
+		Addr->sin_port = htons(static_cast<uint16>(Port));
+		if (inet_pton(AF_INET, TCHAR_TO_ANSI(*Address), &Addr->sin_addr) != 1) return false;
+		Out.Length = sizeof(sockaddr_in);
+	}
+	return true;
+}
+
+void udpClient::apply_socket_options()
+{
+	if (Options.Dscp >= 0)
+	{
+		// DSCP is the upper six bits of the IPv4 TOS / IPv6 traffic class byte
+		// On a dual-stack socket IP_TOS still marks the v4-mapped traffic
+		const int TrafficClass = (Options.Dscp & 0x3F) << 2;
+		const bool bTos = setsockopt(NativeSocket, IPPROTO_IP, IP_TOS, &TrafficClass, sizeof(TrafficClass)) == 0;
+		const bool bTrafficClass = bNativeIPv6 &&
+			setsockopt(NativeSocket, IPPROTO_IPV6, IPV6_TCLASS, &TrafficClass, sizeof(TrafficClass)) == 0;
+		if (!(bNativeIPv6 ? bTrafficClass : bTos))
 		{
-			UE_LOG(LogTemp, Log, TEXT("udpClient: send to %s:%d, receive on :%d"), *ip_address, sPort, rPort);
+			UE_LOG(LogTemp, Warning, TEXT("udpClient: Could not set DSCP %d (errno %d)"), Options.Dscp, errno);
 		}
-		else
+	}
+
+	// After IP_TOS, which resets the priority to one derived from the TOS byte
+	if (Options.SocketPriority >= 0)
+	{
+		const int Priority = Options.SocketPriority;
+		if (setsockopt(NativeSocket, SOL_SOCKET, SO_PRIORITY, &Priority, sizeof(Priority)) != 0)
 		{
-			UE_LOG(LogTemp, Log, TEXT("udpClient: receive-only on :%d"), rPort);
+			UE_LOG(LogTemp, Warning, TEXT("udpClient: Could not set socket priority %d (errno %d)"), Priority, errno);
+		}
+	}
+
+	const unsigned int InterfaceIndex = Options.MulticastInterface.IsEmpty() ? 0 : if_nametoindex(TCHAR_TO_ANSI(*Options.MulticastInterface));
+	if (!Options.MulticastInterface.IsEmpty() && InterfaceIndex == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("udpClient: Unknown multicast interface %s, using the default"), *Options.MulticastInterface);
+	}
+
+	// Multicast sending: only matters when a destination is a group, harmless otherwise
+	const int Hops = FMath::Clamp(Options.MulticastTtl, 0, 255);
+	const int Loopback = Options.bMulticastLoopback ? 1 : 0;
+	if (bNativeIPv6)
+	{
+		setsockopt(NativeSocket, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &Hops, sizeof(Hops));
+		setsockopt(NativeSocket, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &Loopback, sizeof(Loopback));
+		if (InterfaceIndex != 0)
+		{
+			setsockopt(NativeSocket, IPPROTO_IPV6, IPV6_MULTICAST_IF, &InterfaceIndex, sizeof(InterfaceIndex));
 		}
 	}
-	bNewData = false;
+	setsockopt(NativeSocket, IPPROTO_IP, IP_MULTICAST_TTL, &Hops, sizeof(Hops));
+	setsockopt(NativeSocket, IPPROTO_IP, IP_MULTICAST_LOOP, &Loopback, sizeof(Loopback));
+	if (InterfaceIndex != 0)
+	{
+		ip_mreqn Request = {};
+		Request.imr_ifindex = static_cast<int>(InterfaceIndex);
+		setsockopt(NativeSocket, IPPROTO_IP, IP_MULTICAST_IF, &Request, sizeof(Request));
+	}
+
+	if (Options.MulticastGroup.IsEmpty() || !bReceiveIsEnabled) return;
+
+	bool bJoined = false;
+	if (Options.MulticastGroup.Contains(TEXT(":")))
+	{
+		ipv6_mreq Request = {};
+		Request.ipv6mr_interface = InterfaceIndex;
+		bJoined = inet_pton(AF_INET6, TCHAR_TO_ANSI(*Options.MulticastGroup), &Request.ipv6mr_multiaddr) == 1 &&
+			setsockopt(NativeSocket, IPPROTO_IPV6, IPV6_JOIN_GROUP, &Request, sizeof(Request)) == 0;
+	}
+	else
+	{
+		ip_mreqn Request = {};
+		Request.imr_ifindex = static_cast<int>(InterfaceIndex);
+		bJoined = inet_pton(AF_INET, TCHAR_TO_ANSI(*Options.MulticastGroup), &Request.imr_multiaddr) == 1 &&
+			setsockopt(NativeSocket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &Request, sizeof(Request)) == 0;
+	}
+
+	if (bJoined)
+	{
+		UE_LOG(LogTemp, Log, TEXT("udpClient: Joined multicast group %s"), *Options.MulticastGroup);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("udpClient: Could not join multicast group %s (errno %d)"), *Options.MulticastGroup, errno);
+	}
 }
 
-udpClient::~udpClient()
+#else
+
+bool udpClient::open_socket()
 {
-	stop();
+	// The address decides the protocol; an explicit IPv6 request opens a dual-stack socket
+	if (bWriteIsEnabled)
+	{
+		RemoteAddr = SocketSubsystem->GetAddressFromString(ip);
+		if (!RemoteAddr.IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("udpClient: Invalid IP address: %s"), *ip);
+			return false;
+		}
+		RemoteAddr->SetPort(sendPort);
+	}
+
+	const bool bIPv6 = Options.bIPv6 || Options.MulticastGroup.Contains(TEXT(":")) ||
+		(RemoteAddr.IsValid() && RemoteAddr->GetProtocolType() == FNetworkProtocolTypes::IPv6);
+	const FName Protocol = bIPv6 ? FNetworkProtocolTypes::IPv6 : FNetworkProtocolTypes::IPv4;
+
+	Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("UdpClientSocket"), Protocol);
+	if (!Socket)
+	{
+		UE_LOG(LogTemp, Error, TEXT("udpClient: Failed to create UDP socket."));
+		return false;
+	}
+	Socket->SetReuseAddr(true);
+	Socket->SetRecvErr(true);
+	Socket->SetNonBlocking(true);
+	if (bIPv6)
+	{
+		Socket->SetIPv6Only(false);
+	}
+
+	if (bReceiveIsEnabled)
+	{
+		LocalAddr = SocketSubsystem->CreateInternetAddr(Protocol);
+		LocalAddr->SetAnyAddress();
+		LocalAddr->SetPort(receivePort);
+
+		if (!Socket->Bind(*LocalAddr))
+		{
+			UE_LOG(LogTemp, Error, TEXT("udpClient: Failed to bind socket to port %d"), receivePort);
+			return false;
+		}
+	}
+
+	apply_socket_options();
+	return true;
+}
+
+void udpClient::apply_socket_options()
+{
+	if (Options.Dscp >= 0 || Options.SocketPriority >= 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("udpClient: DSCP and socket priority need the native socket path, ignored"));
+	}
+
+	Socket->SetMulticastTtl(static_cast<uint8>(FMath::Clamp(Options.MulticastTtl, 0, 255)));
+	Socket->SetMulticastLoopback(Options.bMulticastLoopback);
+
+	if (Options.MulticastGroup.IsEmpty() || !bReceiveIsEnabled) return;
+
+	if (!Options.MulticastInterface.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("udpClient: Multicast interface selection needs the native socket path, using the default"));
+	}
+
+	TSharedPtr<FInternetAddr> GroupAddr = SocketSubsystem->GetAddressFromString(Options.MulticastGroup);
+	if (GroupAddr.IsValid() && Socket->JoinMulticastGroup(*GroupAddr))
+	{
+		UE_LOG(LogTemp, Log, TEXT("udpClient: Joined multicast group %s"), *Options.MulticastGroup);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("udpClient: Could not join multicast group %s"), *Options.MulticastGroup);
+	}
+}
+
+#endif
+
+void udpClient::set_endpoint_address(uint8 Endpoint, const FString& Ip, int32 Port)
+{
+	if (!bWriteIsEnabled || Endpoint >= FPacketDemux::MaxEndpoints)
+	{
+		UE_LOG(LogTemp, Error, TEXT("udpClient: Cannot address endpoint %d"), Endpoint);
+		return;
+	}
+
+#if UDPCLIENT_NATIVE_BATCHING
+	FNativeAddress Addr;
+	if (!resolve_native(Ip, Port, Addr))
+	{
+		UE_LOG(LogTemp, Error, TEXT("udpClient: Invalid IP address for endpoint %d: %s%s"), Endpoint, *Ip,
+			(!bNativeIPv6 && Ip.Contains(TEXT(":"))) ? TEXT(" (IPv6 needs an IPv6 socket)") : TEXT(""));
+		return;
+	}
+	NativeRemotes[Endpoint] = Addr;
+#else
+	TSharedPtr<FInternetAddr> Addr = SocketSubsystem->GetAddressFromString(Ip);
+	if (!Addr.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("udpClient: Invalid IP address for endpoint %d: %s"), Endpoint, *Ip);
+		return;
+	}
+	Addr->SetPort(Port);
+	EndpointAddrs[Endpoint] = Addr;
+#endif
+
+	UE_LOG(LogTemp, Log, TEXT("udpClient: endpoint %d at %s:%d"), Endpoint, *Ip, Port);
 }
 
 void udpClient::stop()
@@ -84,11 +346,31 @@ void udpClient::stop()
 	if (ReceiverThread)
 	{
 		bStop = true;
+
+		// Wake the receive thread out of its wait instead of waiting for the timeout
+#if UDPCLIENT_NATIVE_BATCHING
+		if (NativeSocket >= 0)
+		{
+			shutdown(NativeSocket, SHUT_RD);
+		}
+#else
+		if (Socket)
+		{
+			Socket->Shutdown(ESocketShutdownMode::Read);
+		}
+#endif
 		ReceiverThread->WaitForCompletion();
 		delete ReceiverThread;
 		ReceiverThread = nullptr;
 	}
 
+#if UDPCLIENT_NATIVE_BATCHING
+	if (NativeSocket >= 0)
+	{
+		close(NativeSocket);
+		NativeSocket = -1;
+	}
+#endif
 	if (Socket)
 	{
 		Socket->Close();
@@ -102,32 +384,158 @@ void udpClient::stop()
 // Receive thread  stores latest raw packet
 // ============================================================================
 
+#if UDPCLIENT_NATIVE_BATCHING
+
+/**
+ * Kernel receive time of a datagram from its SCM_TIMESTAMPNS control message, on
+ * the FPlatformTime::Seconds() clock. The stamp is wall clock time, so only its age
+ * relative to RealtimeNow (read together with Now) is used. Returns Now if the
+ * datagram carries no timestamp.
+ */
+static double KernelReceiveTime(const msghdr& Header, const timespec& RealtimeNow, double Now)
+{
+	for (cmsghdr* Control = CMSG_FIRSTHDR(&Header); Control; Control = CMSG_NXTHDR(const_cast<msghdr*>(&Header), Control))
+	{
+		if (Control->cmsg_level == SOL_SOCKET && Control->cmsg_type == SCM_TIMESTAMPNS)
+		{
+			timespec Stamp;
+			FMemory::Memcpy(&Stamp, CMSG_DATA(Control), sizeof(Stamp));
+
+			// In integer nanoseconds: epoch seconds as a double would cost sub-microsecond precision.
+			// A wall clock step backwards since the datagram arrived makes the age negative.
+			const int64 AgeNs = (static_cast<int64>(RealtimeNow.tv_sec) - Stamp.tv_sec) * 1000000000LL + (RealtimeNow.tv_nsec - Stamp.tv_nsec);
+			return Now - FMath::Max<int64>(AgeNs, 0) * 1e-9;
+		}
+	}
+	return Now;
+}
+
 uint32 udpClient::Run()
 {
+	// One contiguous buffer, sliced into RecvBatchSize datagram slots
 	TArray<uint8> Buffer;
-	Buffer.SetNumUninitialized(BufferSize);
+	Buffer.SetNumUninitialized(RecvBatchSize * BufferSize);
+
+	mmsghdr Msgs[RecvBatchSize];
+	iovec Iovecs[RecvBatchSize];
+
+	// One control message slot per datagram, for its receive timestamp
+	static constexpr int32 ControlSize = CMSG_SPACE(sizeof(timespec));
+	alignas(cmsghdr) uint8 Controls[RecvBatchSize][ControlSize];
+
+	const int WaitTimeout = static_cast<int>(RecvWaitTimeoutMs);
 
 	while (!bStop)
 	{
-		int32 BytesRead = 0;
-		uint32 Pending = 0;
+		// Block until a datagram is readable. The timeout only bounds how long
+		// stop() can take if the wake-up from shutdown() is not delivered.
+		pollfd Pfd = { NativeSocket, POLLIN, 0 };
+		if (poll(&Pfd, 1, WaitTimeout) <= 0)
+		{
+			continue;
+		}
+		if (Pfd.revents & POLLERR)
+		{
+			int Error = 0;
+			socklen_t Len = sizeof(Error);
+			getsockopt(NativeSocket, SOL_SOCKET, SO_ERROR, &Error, &Len);
+		}
 
-		while (Socket->HasPendingData(Pending))
+		// Drain the socket with as few syscalls as possible
+		while (!bStop)
 		{
-			if (Socket->RecvFrom(Buffer.GetData(), BufferSize, BytesRead, *LocalAddr) && BytesRead > 0)
+			for (int32 i = 0; i < RecvBatchSize; ++i)
 			{
-				FScopeLock Lock(&MsgLock);
-				LatestPacket.SetNumUninitialized(BytesRead);
-				FMemory::Memcpy(LatestPacket.GetData(), Buffer.GetData(), BytesRead);
-				bNewData = true;
-				last_recv_time = FPlatformTime::Seconds();
+				Iovecs[i].iov_base = Buffer.GetData() + i * BufferSize;
+				Iovecs[i].iov_len = BufferSize;
+				Msgs[i].msg_hdr = {};
+				Msgs[i].msg_hdr.msg_iov = &Iovecs[i];
+				Msgs[i].msg_hdr.msg_iovlen = 1;
+				if (bKernelTimestamps)
+				{
+					Msgs[i].msg_hdr.msg_control = Controls[i];
+					Msgs[i].msg_hdr.msg_controllen = ControlSize;
+				}
+				Msgs[i].msg_len = 0;
+			}
+
+			const int NumReceived = recvmmsg(NativeSocket, Msgs, RecvBatchSize, MSG_DONTWAIT, nullptr);
+			if (NumReceived <= 0)
+			{
+				break;
+			}
+
+			last_recv_time = FPlatformTime::Seconds();
+
+			// Kernel timestamps are wall clock time: read it once per batch, next to the platform clock
+			timespec RealtimeNow = {};
+			if (bKernelTimestamps)
+			{
+				clock_gettime(CLOCK_REALTIME, &RealtimeNow);
+			}
+
+			for (int32 i = 0; i < NumReceived; ++i)
+			{
+				if (Msgs[i].msg_len > 0)
+				{
+					const double ReceiveTime = bKernelTimestamps
+						? KernelReceiveTime(Msgs[i].msg_hdr, RealtimeNow, last_recv_time)
+						: last_recv_time;
+					dispatch_packet(Buffer.GetData() + i * BufferSize, static_cast<int32>(Msgs[i].msg_len), ReceiveTime);
+				}
+			}
+
+			if (NumReceived < RecvBatchSize)
+			{
+				break;
 			}
 		}
-		FPlatformProcess::Sleep(0.0005f);	// 0.5ms poll interval
 	}
 	return 0;
 }
 
+#else
+
+uint32 udpClient::Run()
+{
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(BufferSize);
+
+	const FTimespan WaitTimeout = FTimespan::FromMilliseconds(RecvWaitTimeoutMs);
+
+	while (!bStop)
+	{
+		// Block until a datagram is readable. The timeout only bounds how long
+		// stop() can take if the wake-up from Shutdown() is not delivered.
+		if (!Socket->Wait(ESocketWaitConditions::WaitForRead, WaitTimeout))
+		{
+			continue;
+		}
+
+		// Drain everything that is queued (socket is non-blocking)
+		int32 BytesRead = 0;
+		while (!bStop && Socket->RecvFrom(Buffer.GetData(), BufferSize, BytesRead, *LocalAddr) && BytesRead > 0)
+		{
+			last_recv_time = FPlatformTime::Seconds();
+			dispatch_packet(Buffer.GetData(), BytesRead, last_recv_time);
+		}
+	}
+	return 0;
+}
+
+#endif
+
+void udpClient::dispatch_packet(const uint8* Data, int32 Size, double ReceiveTime)
+{
+	// Before validation, so malformed datagrams show up in the recording too
+	if (bRecording)
+	{
+		RecvRecordLane->Record(ERecordDirection::Inbound, Data, Size, ReceiveTime);
+	}
+
+	Demux.Dispatch(Data, Size, ReceiveTime);
+}
+
 // ============================================================================
 // Send  raw bytes
 // ============================================================================
@@ -139,10 +547,32 @@ bool udpClient::send_raw(const uint8* Data, int32 Size)
 		UE_LOG(LogTemp, Warning, TEXT("udpClient: Attempting to send on read-only socket"));
 		return false;
 	}
+
+	if (bRecording)
+	{
+		record_sent(SendRecordLane, Data, &Size, 1);
+	}
+	return transmit(Data, Size);
+}
+
+bool udpClient::transmit(const uint8* Data, int32 Size)
+{
+#if UDPCLIENT_NATIVE_BATCHING
+	if (NativeSocket < 0) return false;
+
+	const uint8 Endpoint = FMath::Min<uint8>(EndpointWire::Peek(Data, Size), FPacketDemux::MaxEndpoints - 1);
+	const FNativeAddress& Remote = NativeRemotes[Endpoint];
+
+	bool bSuccess = sendto(NativeSocket, Data, Size, 0, reinterpret_cast<const sockaddr*>(Remote.Storage), Remote.Length) == Size;
+#else
 	if (!Socket || !RemoteAddr.IsValid()) return false;
 
+	const uint8 Endpoint = FMath::Min<uint8>(EndpointWire::Peek(Data, Size), FPacketDemux::MaxEndpoints - 1);
+	const FInternetAddr& Remote = EndpointAddrs[Endpoint].IsValid() ? *EndpointAddrs[Endpoint] : *RemoteAddr;
+
 	int32 BytesSent = 0;
-	bool bSuccess = Socket->SendTo(Data, Size, BytesSent, *RemoteAddr);
+	bool bSuccess = Socket->SendTo(Data, Size, BytesSent, Remote);
+#endif
 
 	if (!bSuccess)
 	{
@@ -151,24 +581,146 @@ bool udpClient::send_raw(const uint8* Data, int32 Size)
 	return bSuccess;
 }
 
+void udpClient::queue_send(const uint8* Data, int32 Size)
+{
+	if (!bWriteIsEnabled)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("udpClient: Attempting to send on read-only socket"));
+		return;
+	}
+	if (SendBatchSizes.Num() >= MaxSendBatch)
+	{
+		flush_sends();
+	}
+	SendBatchData.Append(Data, Size);
+	SendBatchSizes.Add(Size);
+}
+
+bool udpClient::flush_sends()
+{
+	const int32 NumQueued = SendBatchSizes.Num();
+	if (NumQueued == 0) return true;
+
+	if (bRecording)
+	{
+		record_sent(SendRecordLane, SendBatchData.GetData(), SendBatchSizes.GetData(), NumQueued);
+	}
+	const bool bSuccess = transmit_batch(SendBatchData.GetData(), SendBatchSizes.GetData(), NumQueued);
+
+	SendBatchData.Reset();
+	SendBatchSizes.Reset();
+	return bSuccess;
+}
+
+bool udpClient::send_batch(const uint8* Data, const int32* Sizes, int32 Count)
+{
+	if (Count <= 0) return true;
+	if (!bWriteIsEnabled)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("udpClient: Attempting to send on read-only socket"));
+		return false;
+	}
+
+	if (bRecording)
+	{
+		record_sent(BatchRecordLane, Data, Sizes, Count);
+	}
+	return transmit_batch(Data, Sizes, Count);
+}
+
+bool udpClient::transmit_batch(const uint8* Data, const int32* Sizes, int32 Count)
+{
+	bool bSuccess = true;
+
+#if UDPCLIENT_NATIVE_BATCHING
+	mmsghdr Msgs[MaxSendBatch];
+	iovec Iovecs[MaxSendBatch];
+
+	// Larger batches go out in MaxSendBatch-sized chunks
+	int32 Offset = 0;
+	for (int32 First = 0; First < Count; First += MaxSendBatch)
+	{
+		const int32 NumChunk = FMath::Min(Count - First, MaxSendBatch);
+		for (int32 i = 0; i < NumChunk; ++i)
+		{
+			// One destination per datagram: a batch may address several endpoints
+			const uint8 Endpoint = FMath::Min<uint8>(EndpointWire::Peek(Data + Offset, Sizes[First + i]), FPacketDemux::MaxEndpoints - 1);
+			FNativeAddress& Remote = NativeRemotes[Endpoint];
+
+			Iovecs[i].iov_base = const_cast<uint8*>(Data) + Offset;
+			Iovecs[i].iov_len = Sizes[First + i];
+			Msgs[i].msg_hdr = {};
+			Msgs[i].msg_hdr.msg_name = Remote.Storage;
+			Msgs[i].msg_hdr.msg_namelen = Remote.Length;
+			Msgs[i].msg_hdr.msg_iov = &Iovecs[i];
+			Msgs[i].msg_hdr.msg_iovlen = 1;
+			Offset += Sizes[First + i];
+		}
+
+		// sendmmsg may stop early (e.g. full send buffer); resume from where it left off
+		int32 NumSent = 0;
+		while (NativeSocket >= 0 && NumSent < NumChunk)
+		{
+			const int Result = sendmmsg(NativeSocket, Msgs + NumSent, NumChunk - NumSent, 0);
+			if (Result <= 0)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("udpClient: Batched send failed on port %d (%d of %d sent)"), sendPort, First + NumSent, Count);
+				bSuccess = false;
+				break;
+			}
+			NumSent += Result;
+		}
+	}
+#else
+	int32 Offset = 0;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		bSuccess &= transmit(Data + Offset, Sizes[i]);
+		Offset += Sizes[i];
+	}
+#endif
+
+	return bSuccess;
+}
+
+void udpClient::record_sent(FSessionRecordLane* Lane, const uint8* Data, const int32* Sizes, int32 Count)
+{
+	// Recorded as handed to the socket, whether or not the send then succeeds
+	const double Now = FPlatformTime::Seconds();
+	int32 Offset = 0;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Lane->Record(ERecordDirection::Outbound, Data + Offset, Sizes[i], Now);
+		Offset += Sizes[i];
+	}
+}
+
 // ============================================================================
-// Receive  raw bytes
+// Recording and connection health
 // ============================================================================
 
-TArray<uint8> udpClient::get_raw_data()
+void udpClient::set_recorder(FSessionRecorder* Recorder)
 {
-	FScopeLock Lock(&MsgLock);
-	bNewData = false;
-	return MoveTemp(LatestPacket);
+	if (bRecording || !Recorder)
+	{
+		UE_LOG(LogTemp, Error, TEXT("udpClient: Recorder already set or null"));
+		return;
+	}
+
+	RecvRecordLane = Recorder->AddLane();
+	SendRecordLane = Recorder->AddLane();
+	BatchRecordLane = Recorder->AddLane();
+	if (!RecvRecordLane || !SendRecordLane || !BatchRecordLane)
+	{
+		UE_LOG(LogTemp, Error, TEXT("udpClient: Not enough recorder lanes"));
+		return;
+	}
+
+	// Published by the flag, like the receive observer
+	bRecording = true;
 }
 
 bool udpClient::isConnectionAlive() const
 {
 	return (FPlatformTime::Seconds() - last_recv_time) < 1.5;
 }
-
-int64_t udpClient::get_sender_time()
-{
-	FScopeLock Lock(&MsgLock);
-	return sender_time;
-}
\ No newline at end of file
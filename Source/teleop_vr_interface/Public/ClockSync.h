@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// ============================================================================
+// NTP-style clock offset estimation between the operator and the simulator.
+//
+// One exchange yields four timestamps:
+//   T0  ping sent       (local clock)     T1  ping received  (remote clock)
+//   T3  pong received   (local clock)     T2  pong sent      (remote clock)
+//
+//   offset = ((T1 - T0) + (T2 - T3)) / 2		remote minus local
+//   delay  = (T3 - T0) - (T2 - T1)				network round trip
+//
+// Queuing only ever adds delay, and the offset error of a sample is bounded by
+// half its delay, so the estimate uses the lowest-delay sample of a sliding
+// window (min-filter). Drift is the slope of successive filtered offsets.
+// ============================================================================
+class FClockSync
+{
+public:
+	/** Feed one ping/pong exchange (nanoseconds). Samples with a negative round trip are rejected. */
+	bool AddSample(uint64 T0, uint64 T1, uint64 T2, uint64 T3);
+
+	void Reset();
+
+	/** True once at least one exchange completed */
+	bool IsSynchronized() const { return NumSamples > 0; }
+
+	/** Remote clock minus local clock at the given local time, drift-compensated */
+	int64 GetOffsetNs(uint64 LocalNs) const;
+
+	/** Convert a remote timestamp into the local clock domain */
+	uint64 RemoteToLocal(uint64 RemoteNs, uint64 LocalNs) const
+	{
+		return RemoteNs - static_cast<uint64>(GetOffsetNs(LocalNs));
+	}
+
+	/** Round trip of the sample the offset is currently based on */
+	double GetRoundTripMs() const { return BestDelayNs / 1e6; }
+
+	/** Round trip of the most recent exchange, unfiltered */
+	double GetLastRoundTripMs() const { return LastDelayNs / 1e6; }
+
+	/** Rate difference between the clocks, in parts per million (remote runs fast if positive) */
+	double GetDriftPpm() const { return DriftPpm; }
+
+	uint32 GetSampleCount() const { return NumSamples; }
+
+private:
+	struct FSample
+	{
+		uint64 LocalTime = 0;	// T3
+		int64 OffsetNs = 0;
+		int64 DelayNs = 0;
+	};
+
+	void UpdateDrift();
+
+	static constexpr int32 WindowSize = 8;			// min-filter depth
+	static constexpr int32 DriftHistorySize = 16;	// filtered offsets used for the drift fit
+	static constexpr double MinDriftSpanSeconds = 2.0;
+
+	FSample Window[WindowSize];
+	int32 WindowNext = 0;
+	int32 WindowCount = 0;
+
+	FSample Best;
+	int64 BestDelayNs = 0;
+	int64 LastDelayNs = 0;
+
+	FSample DriftHistory[DriftHistorySize];
+	int32 DriftNext = 0;
+	int32 DriftCount = 0;
+	double DriftPpm = 0.0;
+
+	uint32 NumSamples = 0;
+};
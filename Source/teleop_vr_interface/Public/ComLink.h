@@ -6,6 +6,14 @@
 #include "HAL/PlatformTime.h"
 #include <msgpack.hpp>
 #include "udpClient.h"
+#include "ReplayTransport.h"
+#include "SharedMemoryTransport.h"
+#include "ClockSync.h"
+#include "StreamStats.h"
+#include "FixedRateThread.h"
+#include "ReliableChannel.h"
+#include "RobotStateTelemetry.h"
+#include "SessionRecorder.h"
 #include "ComLink.generated.h"
 
 
@@ -15,6 +23,60 @@
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnRobotStateReceived, const FWireRobotState&);
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnPanTiltStateReceived, const FWirePanTiltState&);
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnSystemStatusReceived, const FWireSystemStatus&);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnEndpointRobotStateReceived, uint8 /*Endpoint*/, const FWireRobotState&);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnEndpointPanTiltStateReceived, uint8 /*Endpoint*/, const FWirePanTiltState&);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnEndpointSystemStatusReceived, uint8 /*Endpoint*/, const FWireSystemStatus&);
+DECLARE_MULTICAST_DELEGATE_FiveParams(FOnCommandResult, uint8 /*Endpoint*/, EMsgType /*Type*/, uint32 /*Sequence*/, ECommandResult /*Result*/, float /*LatencyMs*/);
+
+/** Send policy for one outbound pose stream */
+USTRUCT(BlueprintType)
+struct FPoseStreamSendConfig
+{
+	GENERATED_BODY()
+
+	/** Maximum send rate in Hz (0 = one send per call) */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0.0"))
+	float MaxRateHz = 0.0f;
+
+	/**
+	 * A pose within this distance of the last one sent, and within AngleThresholdDeg of its
+	 * orientation, with the same trigger value, is skipped (cm). Setting either threshold
+	 * enables the check; with both at 0 every pose is sent.
+	 */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0.0"))
+	float PositionThreshold = 0.0f;
+
+	/** Same for orientation, in degrees */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0.0"))
+	float AngleThresholdDeg = 0.0f;
+
+	/** Unchanged poses are still sent at least this often, in seconds (0 = skip them indefinitely) */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0.0"))
+	float KeepAliveInterval = 0.1f;
+};
+
+/** A further robot or camera head served over the same socket as the primary remote */
+USTRUCT(BlueprintType)
+struct FComLinkEndpoint
+{
+	GENERATED_BODY()
+
+	/** Endpoint ID carried in every datagram to and from it (0 is the primary remote) */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "1", ClampMax = "7"))
+	int32 Id = 1;
+
+	/** Shown in logs */
+	UPROPERTY(EditAnywhere, Category = "ComLink")
+	FString Name;
+
+	/** Its address (empty = RemoteIP) */
+	UPROPERTY(EditAnywhere, Category = "ComLink")
+	FString RemoteIP;
+
+	/** Its receive port (0 = SendPort) */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0"))
+	int32 SendPort = 0;
+};
 
 /**
  * ComLink
@@ -27,9 +89,14 @@ DECLARE_MULTICAST_DELEGATE_OneParam(FOnSystemStatusReceived, const FWireSystemSt
  *   - Bind to OnRobotStateReceived / OnPanTiltStateReceived to get incoming data
  *   - Connection health is monitored automatically
  *
+ * Several robots and camera heads can share the one socket as endpoints (see
+ * Endpoints). Hand poses and commands go to ArmEndpoint, head poses to
+ * CameraEndpoint, and the single-endpoint delegates and getters report those;
+ * the OnEndpointX delegates and GetEndpointX getters cover every endpoint.
+ *
  * The component is transport-agnostic from the caller's perspective.
- * Internally it uses UDP for high-frequency streams.
- * TCP for reliable commands will be added later.
+ * Internally it uses UDP for high-frequency streams. Mode commands and config
+ * updates are acknowledged by the remote and retransmitted until confirmed.
  */
 UCLASS(ClassGroup = (TeleOp), meta = (BlueprintSpawnableComponent))
 class TELEOP_VR_INTERFACE_API UComLink : public UActorComponent
@@ -45,6 +112,7 @@ public:
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 	// --- Configuration ---
+	/** Simulator address (IPv4, IPv6 or a multicast group), or "shm://<name>" for a simulator on this machine (shared memory, ports unused) */
 	UPROPERTY(EditAnywhere, Category = "ComLink")
 	FString RemoteIP = TEXT("127.0.0.1");
 
@@ -54,38 +122,385 @@ public:
 	UPROPERTY(EditAnywhere, Category = "ComLink")
 	int32 ReceivePort = 6010;
 
+	/** Further robots or camera heads on the same socket, each tagged with its endpoint ID on the wire */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Endpoints")
+	TArray<FComLinkEndpoint> Endpoints;
+
+	/** Endpoint receiving hand poses and commands; the robot-state and status delegates follow it */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Endpoints", meta = (ClampMin = "0", ClampMax = "7"))
+	int32 ArmEndpoint = 0;
+
+	/** Endpoint receiving head poses; the pan-tilt delegate follows it */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Endpoints", meta = (ClampMin = "0", ClampMax = "7"))
+	int32 CameraEndpoint = 0;
+
+	/** Shared memory only: size of each direction's ring when this side creates the segment */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "64", ClampMax = "1048576"))
+	int32 SharedMemoryRingKB = 1024;
+
+	/** DSCP marking of everything sent, 0-63 (-1 = none). 46 (EF) lets managed switches queue poses ahead of bulk traffic. */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Network", meta = (ClampMin = "-1", ClampMax = "63"))
+	int32 Dscp = -1;
+
+	/** Linux SO_PRIORITY of the socket, 0-6 (-1 = kernel default for the DSCP marking) */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Network", meta = (ClampMin = "-1", ClampMax = "6"))
+	int32 SocketPriority = -1;
+
+	/** Also receive from this multicast group, e.g. robot states published once for several operators (empty = unicast only) */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Network")
+	FString MulticastGroup;
+
+	/** Network interface for multicast, e.g. "eth0" (empty = system default) */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Network")
+	FString MulticastInterface;
+
+	/** Hop limit when RemoteIP is a multicast group */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Network", meta = (ClampMin = "0", ClampMax = "255"))
+	int32 MulticastTtl = 1;
+
+	/** Open an IPv6 (dual-stack) socket. Implied by an IPv6 RemoteIP, endpoint address or multicast group. */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Network")
+	bool bUseIPv6 = false;
+
+	/** Queue depth for SystemStatus so no status change is skipped (0 = keep latest only, like robot states) */
+	UPROPERTY(EditAnywhere, Category = "ComLink")
+	int32 StatusQueueCapacity = 32;
+
+	/** Queue depth for CommandAck and TimeSyncPong, so an ack or clock sample is never overwritten by the next one */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "1"))
+	int32 ReplyQueueCapacity = 32;
+
+	/** Outbound encoding. Inbound packets are accepted in either encoding. */
+	UPROPERTY(EditAnywhere, Category = "ComLink")
+	EWireEncoding WireEncoding = EWireEncoding::Msgpack;
+
+	/** Compact encoding only: send orientations as smallest-three (4 bytes instead of 16) */
+	UPROPERTY(EditAnywhere, Category = "ComLink")
+	bool bCompressQuaternions = false;
+
+	/** Acknowledge robot-state keyframes so the remote may send delta-encoded states in between */
+	UPROPERTY(EditAnywhere, Category = "ComLink")
+	bool bEnableStateDeltas = false;
+
+	/** Minimum time between keyframe acknowledgements per arm, in seconds */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0.0"))
+	float KeyframeAckInterval = 0.05f;
+
+	/** Head pose stream send policy */
+	UPROPERTY(EditAnywhere, Category = "ComLink")
+	FPoseStreamSendConfig HeadSendConfig;
+
+	/** Hand pose streams send policy (left and right are limited independently) */
+	UPROPERTY(EditAnywhere, Category = "ComLink")
+	FPoseStreamSendConfig HandSendConfig;
+
+	/**
+	 * Rate of the dedicated pose sender thread in Hz (0 = send from the game thread).
+	 * The thread re-sends the most recent poses at a steady period, independent of
+	 * frame rate and game-thread hitches. A non-zero per-stream MaxRateHz below this
+	 * rate still caps that stream (a warning is logged at BeginPlay). Off by default; 250 to 1000 Hz suits impedance-controlled arms.
+	 */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0.0", ClampMax = "1000.0"))
+	float PoseSendRateHz = 0.0f;
+
+	/** Sender thread only: stop streaming a pose that has not been refreshed for this long, in seconds */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0.0"))
+	float PoseHoldTimeout = 0.1f;
+
+	/** Robot states buffered for telemetry subscribers; a subscriber further behind loses the oldest */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "2"))
+	int32 TelemetryRingCapacity = 256;
+
+	/** First retransmit timeout for unacknowledged commands, until a round trip has been measured (seconds) */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0.01"))
+	float CommandRetryTimeout = 0.1f;
+
+	/** Transmissions per command, including the first, before it is reported as timed out */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "1"))
+	int32 CommandMaxAttempts = 10;
+
+	/** Interval between clock-sync pings in seconds (0 = disabled, latency is then unavailable) */
+	UPROPERTY(EditAnywhere, Category = "ComLink", meta = (ClampMin = "0.0"))
+	float TimeSyncInterval = 0.25f;
+
+	/** Play this recorded session instead of connecting to the robot (empty = live UDP) */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Replay")
+	FString ReplayFile;
+
+	/** Playback speed relative to the recording (1 = real time, 0 = as fast as possible) */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Replay", meta = (ClampMin = "0.0"))
+	float ReplaySpeed = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "ComLink|Replay")
+	bool bReplayLoop = false;
+
+	/** As fast as possible only: hold each packet until the previous one of its type was processed, so none are lost */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Replay")
+	bool bReplayWaitForConsumer = true;
+
+	/** Record every inbound and outbound datagram to a session file for post-mortems and replay */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Recording")
+	bool bRecordSession = false;
+
+	/** Where session files go (empty = Saved/ComLinkSessions) */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Recording")
+	FString RecordingDirectory;
+
+	/** Capture buffer per recording thread in KB; datagrams are dropped (and counted) when the writer falls behind */
+	UPROPERTY(EditAnywhere, Category = "ComLink|Recording", meta = (ClampMin = "64"))
+	int32 RecordingBufferKB = 4096;
+
 	// --- Send API (typed, clean  caller never touches serialization) ---
 
-	/** Send head pose. Converts from Unreal coords to protocol coords internally. */
+	/** Queue head pose. Converts from Unreal coords to protocol coords internally. Subject to HeadSendConfig. */
 	void SendHeadPose(const FTrackedPose& Pose);
 
-	/** Send hand pose with trigger value. Specify left or right. */
+	/** Queue hand pose with trigger value. Specify left or right. Subject to HandSendConfig. */
 	void SendHandPose(const FTrackedPose& Pose, float TriggerValue, bool bIsLeft);
 
-	/** Send a mode transition command. */
-	void SendModeCommand(EOpMode Mode);
+	/**
+	 * Send a mode transition command. Sent immediately, not batched, and retransmitted
+	 * with exponential backoff until the remote acknowledges it. A newer mode command
+	 * supersedes a pending one. Returns the command's sequence number.
+	 */
+	uint32 SendModeCommand(EOpMode Mode, FOnCommandComplete OnComplete = FOnCommandComplete());
+
+	/** Send a parameter update over the same reliable channel. Supersedes a pending update of the same key. */
+	uint32 SendConfigUpdate(uint16 Key, float Value, FOnCommandComplete OnComplete = FOnCommandComplete());
+
+	/** Same, to one endpoint instead of ArmEndpoint. Sequences and superseding are per endpoint. */
+	uint32 SendModeCommandTo(uint8 Endpoint, EOpMode Mode, FOnCommandComplete OnComplete = FOnCommandComplete());
+	uint32 SendConfigUpdateTo(uint8 Endpoint, uint16 Key, float Value, FOnCommandComplete OnComplete = FOnCommandComplete());
+
+	/** Switch the arm or camera endpoint; takes effect with the next pose and the next received state */
+	void SetArmEndpoint(int32 Endpoint);
+	void SetCameraEndpoint(int32 Endpoint);
+
+	/**
+	 * Transmit all poses queued this frame in a single batch, or with the sender
+	 * thread running, publish them to it. Call once after the last SendXPose.
+	 */
+	void FlushSends();
 
 	// --- Receive delegates (other components bind to these) ---
+
+	/** Game thread, once per frame per arm. High-rate consumers should use the telemetry API below. */
 	FOnRobotStateReceived OnRobotStateReceived;
 	FOnPanTiltStateReceived OnPanTiltStateReceived;
 	FOnSystemStatusReceived OnSystemStatusReceived;
 
-	// --- Connection health ---
-	bool IsConnected() const;
-	float GetLatencyMs() const { return LastLatencyMs; }
-	double GetLastReceiveTime() const { return LastReceiveTime; }
+	/** Same for every endpoint, tagged with the one that sent it */
+	FOnEndpointRobotStateReceived OnEndpointRobotStateReceived;
+	FOnEndpointPanTiltStateReceived OnEndpointPanTiltStateReceived;
+	FOnEndpointSystemStatusReceived OnEndpointSystemStatusReceived;
+
+	/** Every reliable command's outcome (confirmed, timed out, superseded or cancelled) */
+	FOnCommandResult OnCommandResult;
+
+	// --- Robot-state telemetry (published from the receive thread, every state) ---
+
+	/** Run Callback on a dedicated worker thread for every robot state of ArmEndpoint. Returns a handle for unsubscribing. */
+	int32 SubscribeRobotStates(const TCHAR* Name, FRobotStateTelemetry::FCallback Callback);
+	void UnsubscribeRobotStates(int32 Handle);
+
+	/** Newest robot state of one arm without waiting for the frame's delegate broadcast */
+	bool GetLatestRobotState(bool bLeft, FWireRobotState& Out);
+
+	/** Direct access for cursor-based polling and back-pressure counters */
+	FRobotStateTelemetry* GetRobotStateTelemetry() { return EnsureTelemetry(); }
+
+	// --- Connection health (of ArmEndpoint unless stated otherwise) ---
+	bool IsConnected() const { return IsEndpointConnected(static_cast<uint8>(ArmEndpoint)); }
+	bool IsEndpointConnected(uint8 Endpoint) const;
+
+	/** One-way simulator -> operator latency of the last robot state, corrected for clock offset */
+	float GetLatencyMs() const { return GetEndpointLatencyMs(static_cast<uint8>(ArmEndpoint)); }
+	float GetEndpointLatencyMs(uint8 Endpoint) const { return GetEndpointState(Endpoint).LastLatencyMs; }
+
+	/** Smoothed variation of the one-way latency (RFC 3550 interarrival jitter) */
+	float GetLatencyJitterMs() const { return GetEndpointState(ArmEndpoint).LatencyJitterMs; }
+
+	/** False until the first ping/pong exchange; latency figures are not updated before that */
+	bool IsClockSynchronized() const { return GetEndpointState(ArmEndpoint).ClockSync.IsSynchronized(); }
+
+	/** Remote clock minus local clock, and its drift rate */
+	double GetClockOffsetMs() const { return GetEndpointState(ArmEndpoint).ClockSync.GetOffsetNs(NowNs()) / 1e6; }
+	double GetClockDriftPpm() const { return GetEndpointState(ArmEndpoint).ClockSync.GetDriftPpm(); }
+
+	/** Round trip of the exchange the clock offset is based on */
+	double GetRoundTripMs() const { return GetEndpointState(ArmEndpoint).ClockSync.GetRoundTripMs(); }
+
+	// --- Per-stream sequence statistics (stale and duplicate packets are dropped) ---
+
+	/** Loss, reorder and inter-arrival statistics of one inbound stream (pan-tilt from CameraEndpoint, the rest from ArmEndpoint) */
+	const FComStreamStats& GetStreamStats(EComStream Stream) const;
+	const FComStreamStats& GetEndpointStreamStats(uint8 Endpoint, EComStream Stream) const;
+
+	/** Network loss across all inbound streams of all endpoints since the last reset, in percent */
+	float GetPacketLossPercent() const;
+
+	void ResetStreamStats();
+
+	double GetLastReceiveTime() const { return GetEndpointState(ArmEndpoint).LastReceiveTime; }
+
+	/** Inbound packets superseded or dropped before the game thread processed them */
+	uint32 GetDroppedPacketCount() const { return Socket ? Socket->get_dropped_count() : 0; }
+
+	/** Poses skipped by the send-rate limiter / because they had not changed */
+	uint32 GetPosesRateLimited() const { return PosesRateLimited.Load(); }
+	uint32 GetPosesDeduplicated() const { return PosesDeduplicated.Load(); }
+
+	/** Pose sender thread timing: cycles started over a period late, and period jitter */
+	uint32 GetPoseSenderOverruns() const { return PoseSender ? PoseSender->GetOverrunCount() : 0; }
+	float GetPoseSenderJitterUs() const { return PoseSender ? PoseSender->GetPeriodJitterUs() : 0.0f; }
+
+	/** Reliable command delivery: counts, confirm latency and current retransmit timeout */
+	const FReliableChannelStats& GetCommandStats() const { return Commands.GetStats(); }
+
+	/** Session being replayed, nullptr when connected to the robot */
+	const FReplayTransport* GetReplay() const { return Replay; }
+
+	/** Active session recording, nullptr if not recording */
+	const FSessionRecorder* GetSessionRecorder() const { return Recorder.Get(); }
+
+	/** Delta-encoded robot states reconstructed / dropped for referencing an unknown keyframe */
+	uint32 GetStateDeltasApplied() const { return DeltasApplied; }
+	uint32 GetStateDeltaMisses() const { return DeltaMisses; }
 
 private:
 
 	void ProcessIncoming();
-	void RouteMessage(const char* Data, int32 Size);
+	void RouteMessage(uint8 Endpoint, const uint8* Data, int32 Size, double ReceiveTime);
+
+	/** Sequence check: false if the packet is a duplicate or older than the last accepted one */
+	bool AcceptSequence(uint8 Endpoint, uint8 MsgType, uint32 Sequence, double ReceiveTime);
+	static EComStream StreamForType(uint8 MsgType);
+
+	void SubmitPose(EMsgType Type, const FTrackedPose& Pose, float TriggerValue);
+	void BuildWirePose(EMsgType Type, uint8 Endpoint, const FTrackedPose& Pose, float TriggerValue, FWirePose& Out);
+	void EncodePose(uint8 Endpoint, const FWirePose& Wire, TFunctionRef<void(const uint8*, int32)> Emit) const;
+	bool UseCompactEncoding() const;
+
+	/** Endpoint a pose stream goes to: the camera head for head poses, the arm otherwise */
+	uint8 PoseEndpoint(EMsgType Type) const;
+
+	/** Hand an encoded message to Emit behind Endpoint's envelope (none for the primary endpoint) */
+	static void EmitTo(uint8 Endpoint, const uint8* Data, int32 Size, TFunctionRef<void(const uint8*, int32)> Emit);
+
+	/** Sender thread: one fixed-rate cycle over the latest pose snapshot */
+	void RunPoseSendCycle();
+
+	void OnRobotStateKeyframe(uint8 Endpoint, const FWireRobotState& State);
+	bool ApplyStateDelta(uint8 Endpoint, const FWireRobotStateDelta& Delta, FWireRobotState& OutState);
+	void SendStateAck(uint8 Endpoint, uint8 StateType, uint32 KeyframeSequence);
+	static int32 KeyframeArmIndex(uint8 StateType);
+
+	/** The remote's sequence numbers start over: restart every stream tracker and drop cached keyframes */
+	void RestartRemoteSequences();
+
+	FRobotStateTelemetry* EnsureTelemetry();
+
+	uint32 SendReliable(uint8 Endpoint, EMsgType Type, uint32 Sequence, uint32 SupersedeKey, const uint8* Data, int32 Size,
+		FOnCommandComplete OnComplete);
+
+	void SendTimeSyncPing(uint8 Endpoint);
+	void OnTimeSyncPong(uint8 Endpoint, const FWireTimeSyncPong& Pong, double ReceiveTime);
+	void UpdateLatency(uint8 Endpoint, uint64 RemoteTimestamp, double ReceiveTime);
+	static uint64 NowNs() { return static_cast<uint64>(FPlatformTime::Seconds() * 1e9); }
+
+	/** Rate limit and change check for one pose stream. Records the pose if it should be sent. */
+	bool ShouldSendPose(EMsgType Type, uint8 Endpoint, const FTrackedPose& Pose, float TriggerValue);
+
+	/** Each endpoint and message type numbers its packets independently, so the receiver can track loss per stream */
+	uint32 NextSequence(uint8 Endpoint, EMsgType Type);
+
+	/** Valid endpoint ID, for checking editor and Blueprint input */
+	static bool IsValidEndpoint(int32 Endpoint) { return Endpoint >= 0 && Endpoint < MaxEndpoints; }
+
+	TUniquePtr<ITransport> Socket;
+	FReplayTransport* Replay = nullptr;	// Socket, when replaying
+	uint32 ReplayLoops = 0;				// replay passes seen by the game thread
+	uint32 TelemetryReplayLoops = 0;	// and by the receive observer
+
+	/** RemoteIP prefix selecting the shared-memory transport */
+	static constexpr const TCHAR* SharedMemoryPrefix = TEXT("shm://");
+
+	static constexpr int32 MaxEndpoints = EndpointWire::MaxEndpoints;
+
+	// Outbound pose streams: 0 = head, 1 = left hand, 2 = right hand
+	static constexpr int32 NumPoseStreams = 3;
+	static int32 PoseStreamIndex(EMsgType Type);
+	static EMsgType PoseStreamType(int32 Index);
+
+	struct FPoseSendState
+	{
+		FTrackedPose LastPose;
+		float LastTrigger = 0.0f;
+		double LastSendTime = -1.0;
+		double NextSendTime = 0.0;
+		uint8 LastEndpoint = 0;
+	};
+	FPoseSendState PoseSendStates[NumPoseStreams];	// owned by whichever thread sends poses
+	TAtomic<uint32> PosesRateLimited{ 0 };
+	TAtomic<uint32> PosesDeduplicated{ 0 };
+	TAtomic<bool> bRemoteSendsCompact{ false };
+
+	// Latest poses handed from the game thread to the sender thread
+	struct FPoseSnapshot
+	{
+		FTrackedPose Poses[NumPoseStreams];
+		float Triggers[NumPoseStreams] = {};
+		double UpdateTimes[NumPoseStreams] = { -1.0, -1.0, -1.0 };
+		uint8 Endpoints[NumPoseStreams] = {};
+	};
+	FPoseSnapshot PendingPoses;		// game thread
+	bool bPosesStaged = false;
+	TTripleBuffer<FPoseSnapshot> PoseSnapshot;
+	TUniquePtr<FFixedRateThread> PoseSender;
+
+	// Sender thread's outbound batch
+	TArray<uint8> SenderBatchData;
+	TArray<int32, TInlineAllocator<NumPoseStreams>> SenderBatchSizes;
+
+	// Acknowledged keyframes per arm (0 = right, 1 = left), ring of the most recent
+	static constexpr int32 NumKeyframeSlots = 4;
+	struct FKeyframeHistory
+	{
+		FWireRobotState States[NumKeyframeSlots];
+		int32 Count = 0;
+		int32 Next = 0;
+		double LastAckTime = -1.0;
+	};
+	uint32 DeltasApplied = 0;
+	uint32 DeltaMisses = 0;
+
+	/** Everything tracked per remote endpoint (game thread, except pose sequence counters on the sender thread) */
+	struct FEndpointState
+	{
+		uint32 SequenceCounters[256] = {};
+		FSequenceTracker StreamTrackers[static_cast<int32>(EComStream::Count)];
+		FKeyframeHistory Keyframes[2];
+		FClockSync ClockSync;
+		float LatencyJitterMs = 0.0f;
+		bool bHasLatency = false;
+		double LastReceiveTime = 0.0;
+		float LastLatencyMs = 0.0f;
+	};
+	FEndpointState EndpointStates[MaxEndpoints];
+
+	FEndpointState& GetEndpointState(int32 Endpoint) { return EndpointStates[FMath::Clamp(Endpoint, 0, MaxEndpoints - 1)]; }
+	const FEndpointState& GetEndpointState(int32 Endpoint) const { return EndpointStates[FMath::Clamp(Endpoint, 0, MaxEndpoints - 1)]; }
+
+	/** Endpoints pinged for clock sync: the primary, every configured one and every one heard from */
+	uint32 KnownEndpoints = 1;
 
-	uint32 NextSequence();
+	/** ArmEndpoint, for the receive thread's telemetry filter */
+	TAtomic<uint8> TelemetryEndpoint{ 0 };
 
-	TUniquePtr<udpClient> Socket;
+	FReliableChannel Commands;
+	TUniquePtr<FRobotStateTelemetry> Telemetry;
+	TUniquePtr<FSessionRecorder> Recorder;
 
-	uint32 SequenceCounter = 0;
-	double LastReceiveTime = 0.0;
-	float LastLatencyMs = 0.0f;
+	double LastPingTime = -1.0;
 	float ConnectionTimeout = 1.5f;
 };
\ No newline at end of file
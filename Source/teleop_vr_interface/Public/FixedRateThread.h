@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Templates/Function.h"
+
+/**
+ * Runs a callback on its own thread at a fixed rate.
+ *
+ * Deadlines are absolute (start + n * period), so the period does not drift with
+ * the callback's run time. The thread sleeps until shortly before each deadline
+ * and yields for the remainder, since OS sleep granularity is too coarse for
+ * sub-millisecond accuracy. A cycle that starts more than one period late is
+ * counted as an overrun and the schedule restarts from now instead of bursting
+ * to catch up.
+ *
+ * Runs above normal rather than time-critical priority by default, so the short
+ * yield loop never competes with the render and RHI threads for a core.
+ */
+class FFixedRateThread : public FRunnable
+{
+public:
+	FFixedRateThread(const TCHAR* ThreadName, double InRateHz, TFunction<void()> InCycle,
+		EThreadPriority Priority = TPri_AboveNormal);
+	virtual ~FFixedRateThread();
+
+	/** Stop and join the thread. Safe to call more than once. */
+	void Shutdown();
+
+	double GetRateHz() const { return RateHz; }
+	uint32 GetCycleCount() const { return Cycles.Load(); }
+	uint32 GetOverrunCount() const { return Overruns.Load(); }
+
+	/** Smoothed deviation of the actual cycle period from the target, in microseconds */
+	float GetPeriodJitterUs() const { return PeriodJitterUs.Load(); }
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override { bStop = true; }
+
+private:
+	/** Remaining wait below which the thread yields instead of sleeping */
+	static constexpr double SpinThresholdSeconds = 0.0005;
+
+	double RateHz = 0.0;
+	TFunction<void()> Cycle;
+	FRunnableThread* Thread = nullptr;
+
+	TAtomic<bool> bStop{ false };
+	TAtomic<uint32> Cycles{ 0 };
+	TAtomic<uint32> Overruns{ 0 };
+	TAtomic<float> PeriodJitterUs{ 0.0f };
+};
@@ -36,10 +36,10 @@ public:
 		}
 	}
 
-	virtual bool UpdateTexture(UTexture2D* Texture) override
+	virtual bool UpdateTexture(UTextureRenderTarget2D* Target) override
 	{
 		if (!Receiver) return false;
-		return Receiver->UpdateTexture(Texture);
+		return Receiver->UpdateTexture(Target);
 	}
 
 	virtual bool GetDimensions(int32& OutWidth, int32& OutHeight) const override
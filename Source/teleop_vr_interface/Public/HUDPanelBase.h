@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "StreamStats.h"
 #include "HUDPanelBase.generated.h"
 
 
@@ -60,6 +61,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "HUD|Data")
 	float GetComLatency() const;
 
+	/** Communication link packet loss percentage, all inbound streams */
+	UFUNCTION(BlueprintCallable, Category = "HUD|Data")
+	float GetComPacketLoss() const;
+
+	/** Sequence, loss and inter-arrival statistics of one inbound stream */
+	UFUNCTION(BlueprintCallable, Category = "HUD|Data")
+	FComStreamStats GetComStreamStats(EComStream Stream) const;
+
 	/** Whether the communication link is connected */
 	UFUNCTION(BlueprintCallable, Category = "HUD|Data")
 	bool GetComConnected() const;
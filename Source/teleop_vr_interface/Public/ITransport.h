@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+#include "PacketMailbox.h"
+
+class FSessionRecorder;
+
+/**
+ * Datagram transport underneath UComLink.
+ *
+ * Sends are fire-and-forget; received datagrams are demultiplexed by their
+ * endpoint envelope and type byte and handed to the game thread through drain().
+ * Outbound datagrams carry their endpoint envelope already; a transport that can
+ * reach endpoints at different addresses routes on it. Implementations: udpClient
+ * (live UDP socket), FSharedMemoryTransport (simulator on the same host) and
+ * FReplayTransport (recorded session).
+ */
+class ITransport
+{
+public:
+	virtual ~ITransport() = default;
+
+	/** Stop background threads and release the underlying resource. Safe to call more than once. */
+	virtual void stop() = 0;
+
+	// --- Send (caller handles serialization) ---
+	virtual bool send_raw(const uint8* Data, int32 Size) = 0;
+
+	/** Copy a message into the outbound batch (game thread). */
+	virtual void queue_send(const uint8* Data, int32 Size) = 0;
+
+	/** Send everything queued since the last flush. Returns false if any datagram failed. */
+	virtual bool flush_sends() = 0;
+
+	/** Send datagrams stored back to back in Data. May be called from one thread other than the game thread. */
+	virtual bool send_batch(const uint8* Data, const int32* Sizes, int32 Count) = 0;
+
+	/** Deliver datagrams enveloped for Endpoint to this address instead of the primary one. Call before sending. */
+	virtual void set_endpoint_address(uint8 Endpoint, const FString& Ip, int32 Port) = 0;
+
+	// --- Receive ---
+	/** Returns true if any packet arrived since the last call to drain */
+	virtual bool has_new_data() const = 0;
+
+	/** Visit every packet received since the last call. Must be called from a single thread. */
+	virtual void drain(TFunctionRef<void(const FRawPacket&)> Visitor) = 0;
+
+	/** Route every packet of this type, from every endpoint, through a bounded FIFO instead of the latest-value mailbox. */
+	virtual void enable_queue(uint8 MsgType, int32 Capacity) = 0;
+
+	/** Inspect every well-formed datagram on the receiving thread. Must be fast and must not block. Call once. */
+	virtual void set_receive_observer(TFunction<void(uint8 Endpoint, uint8 MsgType, const uint8* Data, int32 Size, double ReceiveTime)> Observer) = 0;
+
+	/** Capture traffic to a session recorder that outlives the transport. Call once. */
+	virtual void set_recorder(FSessionRecorder* Recorder) = 0;
+
+	/** Packets superseded before being read, rejected by a full queue, or without a readable type byte */
+	virtual uint32 get_dropped_count() const = 0;
+
+	/** Packets of one endpoint and type superseded in its mailbox or rejected by its full queue */
+	virtual uint32 get_dropped_count(uint8 Endpoint, uint8 MsgType) const = 0;
+
+	/** Connection health check */
+	virtual bool isConnectionAlive() const = 0;
+};
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
 
 
 struct FVideoSourceStats
@@ -30,10 +30,11 @@ public:
 	virtual void Stop() = 0;
 
 	/**
-	 * Update the provided texture with the latest frame.
+	 * Write the latest frame into the provided render target, resizing it to the
+	 * frame's dimensions if they changed. Game thread only.
 	 * Returns true if a new frame was written.
 	 */
-	virtual bool UpdateTexture(UTexture2D* Texture) = 0;
+	virtual bool UpdateTexture(UTextureRenderTarget2D* Target) = 0;
 
 	/** Get current frame dimensions. Returns false if no frame received yet. */
 	virtual bool GetDimensions(int32& OutWidth, int32& OutHeight) const = 0;
@@ -95,9 +95,9 @@ public:
 		bRunning = false;
 	}
 
-	virtual bool UpdateTexture(UTexture2D* Texture) override
+	virtual bool UpdateTexture(UTextureRenderTarget2D* Target) override
 	{
-		if (!bRunning || !NDITexture || !IsValid(NDITexture) || !Texture) return false;
+		if (!bRunning || !NDITexture || !IsValid(NDITexture) || !Target) return false;
 
 		FTextureResource* NDIRes = NDITexture->GetResource();
 		if (!NDIRes || !NDIRes->TextureRHI) return false;
@@ -111,19 +111,26 @@ public:
 
 		if (CachedWidth == 0 || CachedHeight == 0) return false;
 
-		FTextureResource* TargetRes = Texture->GetResource();
-		if (!TargetRes || !TargetRes->TextureRHI) return false;
+		// Follow the sender's resolution; the target is reallocated in place ahead of the copy
+		if (Target->SizeX != CachedWidth || Target->SizeY != CachedHeight)
+		{
+			Target->ResizeTarget(CachedWidth, CachedHeight);
+		}
 
-		FRHITexture2D* TargetRHI = TargetRes->TextureRHI->GetTexture2D();
-		if (!TargetRHI) return false;
+		FTextureResource* TargetRes = Target->GetResource();
+		if (!TargetRes) return false;
 
 		// Copy full NDI frame to target texture via render command
 		const uint32 W = CachedWidth;
 		const uint32 H = CachedHeight;
 
 		ENQUEUE_RENDER_COMMAND(CopyNDIFrame)(
-			[SourceRHI, TargetRHI, W, H](FRHICommandListImmediate& RHICmdList)
+			[SourceRHI, TargetRes, W, H](FRHICommandListImmediate& RHICmdList)
 			{
+				// Resolved here so a resize queued this frame has already taken effect
+				FRHITexture* TargetRHI = TargetRes->GetTexture2DRHI();
+				if (!TargetRHI) return;
+
 				FRHICopyTextureInfo CopyInfo;
 				CopyInfo.SourcePosition.X = 0;
 				CopyInfo.Size.X = W;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+#include "PacketMailbox.h"
+#include "TeleOpTypes.h"
+
+/**
+ * Receive-side routing shared by every transport: datagrams are sorted by their
+ * endpoint and type byte into a latest-value mailbox, or into a bounded FIFO for
+ * types where every packet matters. One producer thread dispatches, one consumer drains.
+ */
+class FPacketDemux
+{
+public:
+	using FObserver = TFunction<void(uint8 Endpoint, uint8 MsgType, const uint8* Data, int32 Size, double ReceiveTime)>;
+
+	FPacketDemux();
+
+	/**
+	 * Producer: strip the endpoint envelope and route one datagram. Returns false if
+	 * it has no readable type byte or names an unknown endpoint.
+	 */
+	bool Dispatch(const uint8* Data, int32 Size, double ReceiveTime);
+
+	/** Producer: true if the next packet of this endpoint and type would overwrite or be rejected */
+	bool IsBacklogged(uint8 Endpoint, uint8 MsgType) const;
+
+	/** Returns true if any packet arrived since the last call to Drain */
+	bool HasNewData() const { return bNewData; }
+
+	/**
+	 * Visit every packet dispatched since the last call. Queued types are visited in
+	 * arrival order, all other types deliver only their newest packet per endpoint.
+	 */
+	void Drain(TFunctionRef<void(const FRawPacket&)> Visitor);
+
+	/** Route every packet of this type, from any endpoint, through a FIFO instead of the mailbox. Call once per type. */
+	void EnableQueue(uint8 MsgType, int32 Capacity);
+
+	/** Inspect every well-formed datagram on the producer thread. Must be fast and must not block. Call once. */
+	void SetObserver(FObserver Observer);
+
+	/** Packets superseded before being read, rejected by a full queue, or malformed */
+	uint32 GetDroppedCount() const;
+
+	/** Packets of one endpoint and type superseded in its mailbox or rejected by its full queue */
+	uint32 GetDroppedCount(uint8 Endpoint, uint8 MsgType) const;
+
+	static constexpr int32 NumMsgTypes = 256;
+	static constexpr int32 MaxEndpoints = EndpointWire::MaxEndpoints;
+
+private:
+	static int32 RouteIndex(uint8 Endpoint, uint8 MsgType) { return Endpoint * NumMsgTypes + MsgType; }
+
+	FPacketMailbox Mailboxes[MaxEndpoints * NumMsgTypes];
+	TAtomic<FPacketRing*> Queues[MaxEndpoints * NumMsgTypes];
+	TArray<TUniquePtr<FPacketRing>> QueueStorage;
+
+	/** One bit per endpoint that has sent anything, so Drain only scans those */
+	TAtomic<uint32> SeenEndpoints{ 0 };
+
+	TAtomic<uint32> MalformedPackets{ 0 };
+	FObserver Observer;
+	TAtomic<bool> bHasObserver{ false };
+	TAtomic<bool> bNewData{ false };
+};
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <type_traits>
+
+// ============================================================================
+// Lock-free hand-off between one producer thread and its consumers:
+// received packets (UDP receive thread -> game thread), outbound pose
+// snapshots (game thread -> pose sender thread) and telemetry fan-out
+// (UDP receive thread -> any number of subscriber threads).
+// ============================================================================
+
+/**
+ * Raw datagram plus its arrival time and the endpoint that sent it.
+ * Storage is reused between writes, so steady-state traffic does not allocate.
+ */
+struct FRawPacket
+{
+	TArray<uint8> Data;
+	double ReceiveTime = 0.0;		// FPlatformTime::Seconds(); the kernel's arrival stamp where the transport has one
+	uint8 Endpoint = 0;
+
+	void Assign(const uint8* InData, int32 Size, double InReceiveTime, uint8 InEndpoint)
+	{
+		Data.Reset();
+		Data.Append(InData, Size);
+		ReceiveTime = InReceiveTime;
+		Endpoint = InEndpoint;
+	}
+};
+
+/**
+ * Lock-free latest-value hand-off (triple buffer) between one producer and one
+ * consumer. Neither side ever blocks; the consumer always sees a complete value.
+ */
+template<typename T>
+class TTripleBuffer
+{
+public:
+	/** Producer: buffer to fill before Publish(). Holds stale data, overwrite it completely. */
+	T& GetWriteBuffer() { return Buffers[BackIndex]; }
+
+	/** Producer: publish the write buffer. Returns true if the previous value was never picked up. */
+	bool Publish()
+	{
+		const uint8 Prev = Middle.Exchange(BackIndex | DirtyBit);
+		BackIndex = Prev & IndexMask;
+		return (Prev & DirtyBit) != 0;
+	}
+
+	/** Consumer: take the newest value if one was published since the last call. */
+	bool Update()
+	{
+		if (!(Middle.Load(EMemoryOrder::Relaxed) & DirtyBit)) return false;
+
+		const uint8 Prev = Middle.Exchange(FrontIndex);
+		FrontIndex = Prev & IndexMask;
+		return true;
+	}
+
+	/** Either side: a published value is waiting for the consumer */
+	bool HasUnread() const { return (Middle.Load() & DirtyBit) != 0; }
+
+	/** Consumer: value taken by the last successful Update() (default-constructed before that) */
+	const T& GetReadBuffer() const { return Buffers[FrontIndex]; }
+
+private:
+	static constexpr uint8 IndexMask = 0x03;
+	static constexpr uint8 DirtyBit = 0x04;
+
+	T Buffers[3];
+	uint8 BackIndex = 0;		// producer only
+	uint8 FrontIndex = 1;		// consumer only
+	TAtomic<uint8> Middle{ 2 };	// shared slot index + dirty flag
+};
+
+/**
+ * Single-slot latest-value packet mailbox.
+ * The producer never blocks and never waits for the consumer; a packet that is
+ * not read before the next one arrives is overwritten and counted.
+ */
+class FPacketMailbox
+{
+public:
+	/** Producer: copy a packet into the back buffer and publish it. */
+	void Write(const uint8* InData, int32 Size, double ReceiveTime, uint8 Endpoint)
+	{
+		Buffer.GetWriteBuffer().Assign(InData, Size, ReceiveTime, Endpoint);
+		if (Buffer.Publish())
+		{
+			++Overwritten;
+		}
+	}
+
+	/** Consumer: newest packet if one was published since the last read, nullptr otherwise. */
+	const FRawPacket* Read()
+	{
+		return Buffer.Update() ? &Buffer.GetReadBuffer() : nullptr;
+	}
+
+	/** Producer: the next Write() would replace a packet the consumer has not read */
+	bool HasUnread() const { return Buffer.HasUnread(); }
+
+	/** Packets replaced before the consumer got to them */
+	uint32 GetOverwrittenCount() const { return Overwritten.Load(); }
+
+private:
+	TTripleBuffer<FRawPacket> Buffer;
+	TAtomic<uint32> Overwritten{ 0 };
+};
+
+/**
+ * Bounded single-producer / single-consumer FIFO for message types where every
+ * packet matters. When full, the newest packet is dropped and counted.
+ */
+class FPacketRing
+{
+public:
+	explicit FPacketRing(int32 InCapacity)
+	{
+		Capacity = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(InCapacity, 2)));
+		Mask = Capacity - 1;
+		Slots.SetNum(Capacity);
+	}
+
+	/** Producer: append a copy of the packet. Returns false if the ring is full. */
+	bool Push(const uint8* InData, int32 Size, double ReceiveTime, uint8 Endpoint)
+	{
+		const uint32 H = Head.Load(EMemoryOrder::Relaxed);
+		if (H - Tail.Load() >= Capacity)
+		{
+			++Dropped;
+			return false;
+		}
+		Slots[H & Mask].Assign(InData, Size, ReceiveTime, Endpoint);
+		Head.Store(H + 1);
+		return true;
+	}
+
+	/** Consumer: oldest queued packet, nullptr if empty. Valid until Pop(). */
+	const FRawPacket* Peek() const
+	{
+		const uint32 T = Tail.Load(EMemoryOrder::Relaxed);
+		return (T == Head.Load()) ? nullptr : &Slots[T & Mask];
+	}
+
+	/** Consumer: release the packet returned by Peek(). */
+	void Pop()
+	{
+		Tail.Store(Tail.Load(EMemoryOrder::Relaxed) + 1);
+	}
+
+	/** Producer: the next Push() would be rejected */
+	bool IsFull() const { return Head.Load(EMemoryOrder::Relaxed) - Tail.Load() >= Capacity; }
+
+	/** Packets rejected because the consumer fell behind */
+	uint32 GetDroppedCount() const { return Dropped.Load(); }
+
+private:
+	TArray<FRawPacket> Slots;
+	uint32 Capacity = 0;
+	uint32 Mask = 0;
+	TAtomic<uint32> Head{ 0 };		// written by producer
+	TAtomic<uint32> Tail{ 0 };		// written by consumer
+	TAtomic<uint32> Dropped{ 0 };
+};
+
+/**
+ * Single-producer broadcast ring: every reader sees every value, each through
+ * its own cursor, and the producer never waits for any of them. A reader that
+ * falls more than Capacity values behind skips ahead and counts what it missed.
+ *
+ * Slots are guarded by a per-slot version (seqlock), so T must be trivially
+ * copyable: a reader may copy a slot while the producer overwrites it and then
+ * discards the torn copy.
+ */
+template<typename T>
+class TBroadcastRing
+{
+	static_assert(std::is_trivially_copyable<T>::value, "TBroadcastRing requires a trivially copyable type");
+
+public:
+	explicit TBroadcastRing(int32 InCapacity)
+	{
+		Capacity = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(InCapacity, 2)));
+		Mask = Capacity - 1;
+		Slots = MakeUnique<FSlot[]>(Capacity);
+	}
+
+	/** Producer: append a value, overwriting the oldest. */
+	void Publish(const T& Value)
+	{
+		const uint64 Seq = Head.Load(EMemoryOrder::Relaxed);
+		FSlot& Slot = Slots[Seq & Mask];
+
+		Slot.Version.Store(2 * Seq + 1);	// odd: write in progress
+		FPlatformMisc::MemoryBarrier();		// the odd version must be visible before any payload byte
+		FMemory::Memcpy(&Slot.Value, &Value, sizeof(T));
+		Slot.Version.Store(2 * Seq + 2);	// even: holds value Seq
+		Head.Store(Seq + 1);
+	}
+
+	/** Position of the next value to be published; a new reader starts here */
+	uint64 GetHead() const { return Head.Load(); }
+
+	/**
+	 * Reader: copy the value at Cursor and advance it. Returns false when the
+	 * reader has caught up. Values overwritten before they were read are added to Dropped.
+	 */
+	bool Read(uint64& Cursor, T& Out, uint32& Dropped) const
+	{
+		for (;;)
+		{
+			const uint64 H = Head.Load();
+			if (Cursor >= H) return false;
+
+			if (H - Cursor > Capacity)
+			{
+				Dropped += static_cast<uint32>(H - Cursor - Capacity);
+				Cursor = H - Capacity;
+			}
+
+			const FSlot& Slot = Slots[Cursor & Mask];
+			const uint64 Expected = 2 * Cursor + 2;
+			if (Slot.Version.Load() == Expected)
+			{
+				FMemory::Memcpy(&Out, &Slot.Value, sizeof(T));
+				FPlatformMisc::MemoryBarrier();
+				if (Slot.Version.Load() == Expected)
+				{
+					++Cursor;
+					return true;
+				}
+			}
+
+			// Lapped while reading: retry from the new oldest value
+			++Dropped;
+			++Cursor;
+		}
+	}
+
+private:
+	struct FSlot
+	{
+		TAtomic<uint64> Version{ 0 };
+		T Value;
+	};
+
+	TUniquePtr<FSlot[]> Slots;
+	uint32 Capacity = 0;
+	uint32 Mask = 0;
+	TAtomic<uint64> Head{ 0 };		// written by producer
+};
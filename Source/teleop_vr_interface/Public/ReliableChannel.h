@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+
+// ============================================================================
+// Acknowledged delivery for low-rate commands over the unreliable UDP link.
+//
+// Every command keeps its per-type sequence number across retransmissions, so
+// the remote can execute each (type, sequence) once and acknowledge every copy.
+// Endpoints number their commands independently, so commands are matched by
+// (endpoint, type, sequence) and supersede only within their endpoint.
+// Retransmit timeouts follow RFC 6298 (smoothed RTT + 4 * variance, measured
+// only on commands confirmed without a retransmission) and back off
+// exponentially per command. A newer command with the same supersede key
+// replaces a pending one, so a stale mode change is never retransmitted after
+// a newer one.
+// ============================================================================
+
+enum class ECommandResult : uint8
+{
+	Confirmed,		// remote acknowledged
+	TimedOut,		// no acknowledgement after the maximum number of attempts
+	Superseded,		// replaced by a newer command before it was confirmed
+	Cancelled,		// channel shut down
+};
+
+inline const TCHAR* LexToString(ECommandResult Result)
+{
+	switch (Result)
+	{
+	case ECommandResult::Confirmed:		return TEXT("Confirmed");
+	case ECommandResult::TimedOut:		return TEXT("TimedOut");
+	case ECommandResult::Superseded:	return TEXT("Superseded");
+	case ECommandResult::Cancelled:		return TEXT("Cancelled");
+	default:							return TEXT("Unknown");
+	}
+}
+
+/** Completion callback for one command. LatencyMs is first transmission to acknowledgement (0 unless confirmed). */
+DECLARE_DELEGATE_TwoParams(FOnCommandComplete, ECommandResult /*Result*/, float /*LatencyMs*/);
+
+struct FReliableChannelStats
+{
+	uint32 Sent = 0;
+	uint32 Confirmed = 0;
+	uint32 Retransmits = 0;
+	uint32 TimedOut = 0;
+	uint32 Superseded = 0;
+	int32 InFlight = 0;
+
+	/** Send-to-confirm latency: last, running mean and maximum */
+	float LastLatencyMs = 0.0f;
+	float MeanLatencyMs = 0.0f;
+	float MaxLatencyMs = 0.0f;
+
+	/** Current retransmit timeout for a first attempt */
+	float RetransmitTimeoutMs = 0.0f;
+};
+
+class FReliableChannel
+{
+public:
+	using FSendFunction = TFunctionRef<bool(const uint8*, int32)>;
+
+	/** Fires for every finished command, after its own completion delegate */
+	TFunction<void(uint8 Endpoint, uint8 MsgType, uint32 Sequence, ECommandResult Result, float LatencyMs)> OnResult;
+
+	/** Timeout bounds in seconds and attempts per command including the first send */
+	double InitialTimeout = 0.1;
+	double MinTimeout = 0.02;
+	double MaxTimeout = 1.0;
+	int32 MaxAttempts = 10;
+
+	/** Transmit an encoded command now and track it until acknowledged. */
+	void Submit(uint8 Endpoint, uint8 MsgType, uint32 Sequence, uint32 SupersedeKey, const uint8* Data, int32 Size,
+		FOnCommandComplete OnComplete, double Now, FSendFunction Send);
+
+	/** Handle an acknowledgement. Returns false for unknown or already confirmed commands. */
+	bool Acknowledge(uint8 Endpoint, uint8 MsgType, uint32 Sequence, double Now);
+
+	/** Retransmit every command whose timeout expired; time out those out of attempts. */
+	void Tick(double Now, FSendFunction Send);
+
+	/** Drop all pending commands, completing them as Cancelled */
+	void Cancel();
+
+	const FReliableChannelStats& GetStats() const { return Stats; }
+
+private:
+	struct FPendingCommand
+	{
+		uint8 Endpoint = 0;
+		uint8 MsgType = 0;
+		uint32 Sequence = 0;
+		uint32 SupersedeKey = 0;
+		TArray<uint8> Data;
+		FOnCommandComplete OnComplete;
+		double FirstSendTime = 0.0;
+		double NextRetryTime = 0.0;
+		double Timeout = 0.0;
+		int32 Attempts = 0;
+	};
+
+	double CurrentTimeout() const;
+	void Finish(FPendingCommand&& Command, ECommandResult Result, float LatencyMs);
+
+	TArray<FPendingCommand> Pending;
+	FReliableChannelStats Stats;
+
+	// RFC 6298 estimator state, seconds
+	double SmoothedRtt = 0.0;
+	double RttVariance = 0.0;
+	bool bHasRtt = false;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Async/MappedFileHandle.h"
+#include "ITransport.h"
+#include "PacketDemux.h"
+#include "SessionRecorder.h"
+
+/**
+ * Sequential reader for session files written by FSessionRecorder.
+ * The file is memory-mapped; records are returned in place, without copying.
+ */
+class FSessionReader
+{
+public:
+	bool Open(const FString& FilePath);
+	bool IsOpen() const { return Data != nullptr; }
+
+	/**
+	 * Next record, its payload directly following the header. Returns nullptr at
+	 * the end of the file or at the first incomplete chunk.
+	 */
+	const FSessionRecordHeader* Next();
+
+	/** Restart at the first record */
+	void Rewind();
+
+	const FSessionFileHeader& GetFileHeader() const { return Header; }
+
+private:
+	TUniquePtr<IMappedFileHandle> File;
+	TUniquePtr<IMappedFileRegion> Region;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	int64 Cursor = 0;
+	int64 ChunkEnd = 0;		// end of the current chunk's records
+	FSessionFileHeader Header;
+};
+
+/**
+ * Transport that plays a recorded session back instead of talking to a robot.
+ *
+ * Inbound records are dispatched from a replay thread exactly as the UDP receive
+ * thread would, so UComLink and everything above it run unchanged. Sends are
+ * discarded. Replies to the original session's requests (clock-sync pongs,
+ * command acknowledgements) are skipped, since they would answer requests this
+ * session never made.
+ *
+ * Playback starts when the consumer first polls for data, once UComLink has set up
+ * its queues and observers, so no record is dispatched before they exist.
+ *
+ * Playback speed 1 reproduces the recorded timing, larger values compress it,
+ * and 0 plays as fast as possible. When playing as fast as possible with
+ * bWaitForConsumer, a packet is held back until the previous one of its type
+ * was drained, so every recorded packet reaches the game thread in order and
+ * repeated runs see the same sequence.
+ *
+ * When looping, each pass starts the recorded sequence numbers over. The next pass
+ * begins only once the consumer has drained the previous one, and GetLoopCount()
+ * advances before its first packet is dispatched, so a consumer that sees the count
+ * change while handling a packet restarts its sequence tracking there.
+ */
+class FReplayTransport : public ITransport, public FRunnable
+{
+public:
+	struct FConfig
+	{
+		FString FilePath;
+		float Speed = 1.0f;
+		bool bLoop = false;
+		bool bWaitForConsumer = true;
+	};
+
+	explicit FReplayTransport(const FConfig& InConfig);
+	virtual ~FReplayTransport();
+
+	/** True once every record was played (never, when looping) or the file could not be opened */
+	bool IsFinished() const { return bFinished; }
+
+	uint64 GetReplayedCount() const { return Replayed.Load(); }
+	uint32 GetLoopCount() const { return Loops.Load(); }
+
+	// ITransport
+	virtual void stop() override;
+	virtual bool send_raw(const uint8* Data, int32 Size) override { ++DiscardedSends; return true; }
+	virtual void queue_send(const uint8* Data, int32 Size) override { ++DiscardedSends; }
+	virtual bool flush_sends() override { return true; }
+	virtual bool send_batch(const uint8* Data, const int32* Sizes, int32 Count) override { DiscardedSends += Count; return true; }
+	virtual void set_endpoint_address(uint8 Endpoint, const FString& Ip, int32 Port) override {}
+	virtual bool has_new_data() const override;
+	virtual void drain(TFunctionRef<void(const FRawPacket&)> Visitor) override;
+	virtual void enable_queue(uint8 MsgType, int32 Capacity) override { Demux.EnableQueue(MsgType, Capacity); }
+	virtual void set_receive_observer(TFunction<void(uint8 Endpoint, uint8 MsgType, const uint8* Data, int32 Size, double ReceiveTime)> Observer) override
+	{
+		Demux.SetObserver(MoveTemp(Observer));
+	}
+	virtual void set_recorder(FSessionRecorder* Recorder) override;
+	virtual uint32 get_dropped_count() const override { return Demux.GetDroppedCount(); }
+	virtual uint32 get_dropped_count(uint8 Endpoint, uint8 MsgType) const override { return Demux.GetDroppedCount(Endpoint, MsgType); }
+	virtual bool isConnectionAlive() const override;
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override { bStop = true; }
+
+private:
+	/** Play every record once. Returns false if stopped. */
+	bool PlayOnce();
+
+	/** Wait until every dispatched packet was drained. Returns false if stopped. */
+	bool WaitForDrained() const;
+
+	/** Sleep until shortly before Time, then yield for the remainder */
+	void WaitUntil(double Time) const;
+
+	FConfig Config;
+	FSessionReader Reader;
+	FPacketDemux Demux;
+	FRunnableThread* Thread = nullptr;
+
+	TAtomic<bool> bStop{ false };
+	mutable TAtomic<bool> bConsumerReady{ false };
+	TAtomic<bool> bDraining{ false };
+	TAtomic<bool> bFinished{ false };
+	TAtomic<uint64> Replayed{ 0 };
+	TAtomic<uint32> Loops{ 0 };
+	TAtomic<uint32> DiscardedSends{ 0 };
+	TAtomic<double> LastDispatchTime{ 0.0 };
+};
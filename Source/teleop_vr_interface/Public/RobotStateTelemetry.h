@@ -0,0 +1,126 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformTLS.h"
+#include "Templates/Function.h"
+#include "TeleOpTypes.h"
+#include "PacketMailbox.h"
+#include "StreamStats.h"
+
+/** Position of one polling reader in the telemetry ring */
+struct FTelemetryCursor
+{
+	uint64 Position = 0;
+	uint32 Dropped = 0;		// states overwritten before this reader got to them
+};
+
+struct FTelemetrySubscriberStats
+{
+	uint32 Delivered = 0;
+	uint32 Dropped = 0;
+};
+
+/**
+ * Robot-state fan-out, fed from the UDP receive thread.
+ *
+ * Every full or delta-encoded robot state (both arms) is decoded as it arrives
+ * and published to a broadcast ring. Consumers choose how to receive it:
+ *   - Subscribe(): callback on a dedicated worker thread for every state
+ *   - CreateCursor() + Poll(): drain from a thread the caller owns
+ *   - GetLatest(): newest state per arm, for the game thread
+ * None of them run on the game thread or slow the producer; a consumer that
+ * falls behind by more than the ring capacity loses the oldest states and the
+ * loss is counted (back-pressure).
+ *
+ * Stale and duplicate states are filtered by sequence number, and deltas are
+ * reconstructed against a local cache of recent full states.
+ */
+class FRobotStateTelemetry
+{
+public:
+	using FCallback = TFunction<void(const FWireRobotState&)>;
+
+	explicit FRobotStateTelemetry(int32 RingCapacity);
+	~FRobotStateTelemetry();
+
+	/** Receive thread: handle one packet. Types other than robot states are ignored. */
+	void OnPacket(uint8 MsgType, const uint8* Data, int32 Size, double ReceiveTime);
+
+	/** Receive thread: the remote's sequence numbers start over; forget positions and cached keyframes */
+	void RestartSequences();
+
+	/** Game thread: newest state of one arm. False until the first one arrived. */
+	bool GetLatest(bool bLeft, FWireRobotState& Out);
+
+	/** Game thread: start a worker thread that runs Callback for every state. Returns a handle, or INDEX_NONE if all slots are taken. */
+	int32 Subscribe(const TCHAR* Name, FCallback Callback);
+
+	/** Stop and join a subscriber's worker thread. Rejected when called from that subscriber's own callback. */
+	void Unsubscribe(int32 Handle);
+
+	FTelemetrySubscriberStats GetSubscriberStats(int32 Handle) const;
+
+	/** Polling access. Cursors start at the next state to be published. */
+	FTelemetryCursor CreateCursor() const { return FTelemetryCursor{ Ring.GetHead(), 0 }; }
+	bool Poll(FTelemetryCursor& Cursor, FWireRobotState& Out) const { return Ring.Read(Cursor.Position, Out, Cursor.Dropped); }
+
+	uint64 GetPublishedCount() const { return Ring.GetHead(); }
+
+	/** Deltas whose keyframe was not in the local cache */
+	uint32 GetDeltaMisses() const { return DeltaMisses.Load(); }
+
+	static constexpr int32 MaxSubscribers = 8;
+
+private:
+	class FSubscriber : public FRunnable
+	{
+	public:
+		FSubscriber(const TCHAR* Name, const TBroadcastRing<FWireRobotState>& InRing, FCallback InCallback);
+		virtual ~FSubscriber();
+
+		void Wake() { Event->Trigger(); }
+
+		bool IsCurrentThread() const { return Thread && Thread->GetThreadID() == FPlatformTLS::GetCurrentThreadId(); }
+
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+
+		TAtomic<uint32> Delivered{ 0 };
+		TAtomic<uint32> Dropped{ 0 };
+
+	private:
+		const TBroadcastRing<FWireRobotState>& Ring;
+		FCallback Callback;
+		FTelemetryCursor Cursor;
+		FEvent* Event = nullptr;
+		FRunnableThread* Thread = nullptr;
+		TAtomic<bool> bStop{ false };
+	};
+
+	void Publish(const FWireRobotState& State);
+
+	TBroadcastRing<FWireRobotState> Ring;
+
+	// Receive thread only
+	static constexpr int32 NumCachedKeyframes = 8;
+	struct FArmState
+	{
+		FWireRobotState Keyframes[NumCachedKeyframes];
+		int32 NumKeyframes = 0;
+		int32 NextKeyframe = 0;
+		FSequenceTracker Sequence;
+	};
+	FArmState Arms[2];
+	TAtomic<uint32> DeltaMisses{ 0 };
+
+	// Latest value per arm for the game thread
+	TTripleBuffer<FWireRobotState> Latest[2];
+	bool bHasLatest[2] = { false, false };
+
+	// Subscriber slots; the producer reads them while publishing, so removal waits for it
+	TAtomic<FSubscriber*> Subscribers[MaxSubscribers];
+	TAtomic<int32> ActivePublishers{ 0 };
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+
+// Memory-mapped session files need a native file descriptor, which is only
+// wired up on Linux-based platforms. Everything else appends through IFileHandle.
+#ifndef SESSIONRECORDER_MMAP
+#define SESSIONRECORDER_MMAP (PLATFORM_LINUX || PLATFORM_ANDROID)
+#endif
+
+#if !SESSIONRECORDER_MMAP
+#include "GenericPlatform/GenericPlatformFile.h"
+#endif
+
+// ============================================================================
+// Session file format (little-endian, append-only)
+//
+//   FSessionFileHeader
+//   { FSessionChunkHeader, { FSessionRecordHeader, payload, pad to 8 } * RecordCount } *
+//
+// A chunk's payload is written before its header, so a file cut short by a
+// crash ends at the first chunk whose magic is not ChunkMagic.
+// ============================================================================
+
+enum class ERecordDirection : uint8
+{
+	Inbound = 0,	// received from the robot
+	Outbound = 1,	// handed to the socket for sending
+};
+
+namespace SessionFile
+{
+	static constexpr uint64 FileMagic = 0x3143455250454C54ull;	// "TLEPREC1"
+	static constexpr uint32 ChunkMagic = 0x4B4E4843;			// "CHNK"
+	static constexpr uint32 Version = 1;
+	static constexpr uint32 Alignment = 8;
+
+	inline uint32 AlignUp(uint32 Size) { return (Size + Alignment - 1) & ~(Alignment - 1); }
+}
+
+struct FSessionFileHeader
+{
+	uint64 Magic = SessionFile::FileMagic;
+	uint32 Version = SessionFile::Version;
+	uint32 HeaderSize = sizeof(FSessionFileHeader);
+	double StartTime = 0.0;		// FPlatformTime::Seconds() when recording started
+	int64 StartUnixNs = 0;		// wall clock at StartTime, to relate record times to other logs
+};
+
+struct FSessionChunkHeader
+{
+	uint32 Magic = SessionFile::ChunkMagic;
+	uint32 RecordCount = 0;
+	uint32 PayloadBytes = 0;	// bytes following this header
+	uint32 Dropped = 0;			// records lost to full lanes since the previous chunk
+	double FirstTime = 0.0;
+	double LastTime = 0.0;
+};
+
+struct FSessionRecordHeader
+{
+	double Time = 0.0;			// FPlatformTime::Seconds(): arrival for inbound, send for outbound
+	uint32 Size = 0;			// payload bytes, excluding padding
+	uint8 Direction = 0;		// ERecordDirection
+	uint8 Lane = 0;
+	uint16 Reserved = 0;
+};
+
+static_assert(sizeof(FSessionFileHeader) == 32, "Session file header layout changed");
+static_assert(sizeof(FSessionChunkHeader) == 32, "Session chunk header layout changed");
+static_assert(sizeof(FSessionRecordHeader) == 16, "Session record header layout changed");
+
+/**
+ * Per-thread capture buffer: a bounded single-producer byte ring drained by the
+ * recorder's writer thread. Recording copies the datagram and never blocks or
+ * allocates; when the writer falls behind the record is dropped and counted.
+ */
+class FSessionRecordLane
+{
+public:
+	FSessionRecordLane(uint8 InIndex, int32 InCapacityBytes);
+
+	/** Producer: copy one message. Returns false if the lane is full. */
+	bool Record(ERecordDirection Direction, const uint8* Data, int32 Size, double Time);
+
+	/** Consumer: oldest record (header followed by payload), nullptr if empty. Valid until Pop(). */
+	const FSessionRecordHeader* Peek();
+
+	/** Consumer: release the record returned by Peek(). */
+	void Pop();
+
+	uint32 GetRecordedCount() const { return Recorded.Load(); }
+	uint32 GetDroppedCount() const { return Dropped.Load(); }
+
+private:
+	static constexpr uint32 WrapMarker = 0xFFFFFFFFu;
+
+	TUniquePtr<uint8[]> Buffer;
+	uint32 Capacity = 0;
+	uint32 Mask = 0;
+	uint8 Index = 0;
+	TAtomic<uint64> Head{ 0 };		// written by producer
+	TAtomic<uint64> Tail{ 0 };		// written by consumer
+	TAtomic<uint32> Recorded{ 0 };
+	TAtomic<uint32> Dropped{ 0 };
+};
+
+/**
+ * Records wire traffic to an append-only session file.
+ *
+ * Each producing thread records into its own lane, so the send and receive
+ * paths only pay for a copy. A background thread merges the lanes in time
+ * order into chunks and appends them to the file, which on Linux is written
+ * through a sliding memory-mapped window. Memory is bounded by the lane
+ * capacities plus one chunk.
+ */
+class FSessionRecorder : public FRunnable
+{
+public:
+	FSessionRecorder(const FString& InFilePath, int32 InLaneCapacityBytes);
+	virtual ~FSessionRecorder();
+
+	/** True while the file is open and the writer thread runs */
+	bool IsRecording() const { return bRecording; }
+
+	const FString& GetFilePath() const { return FilePath; }
+
+	/**
+	 * Create a lane for one producing thread. Lanes live as long as the recorder.
+	 * Returns nullptr once all lanes are taken.
+	 */
+	FSessionRecordLane* AddLane();
+
+	/** Write everything still buffered and close the file. Safe to call more than once. */
+	void Shutdown();
+
+	uint32 GetRecordedCount() const;
+	uint32 GetDroppedCount() const;
+	uint64 GetBytesWritten() const { return BytesWritten.Load(); }
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	static constexpr int32 MaxLanes = 8;
+
+private:
+	bool OpenFile();
+	void CloseFile();
+
+	/** Merge everything currently buffered in the lanes into chunks. Returns false on a write error. */
+	bool DrainLanes();
+	bool WriteChunk();
+	bool Append(uint64 Offset, const uint8* Data, int32 Size);
+
+	FString FilePath;
+	int32 LaneCapacityBytes = 0;
+
+	TUniquePtr<FSessionRecordLane> LaneStorage[MaxLanes];
+	TAtomic<int32> NumLanes{ 0 };
+
+	// Writer thread only
+	TArray<uint8> ChunkData;
+	FSessionChunkHeader Chunk;
+	uint32 LastDropped = 0;
+	uint64 FileSize = 0;		// bytes of complete chunks written so far
+
+#if SESSIONRECORDER_MMAP
+	int FileDescriptor = -1;
+	uint8* MappedWindow = nullptr;
+	uint64 WindowOffset = 0;
+	uint64 WindowSize = 0;
+	uint64 MappedFileSize = 0;
+#else
+	TUniquePtr<IFileHandle> FileHandle;
+#endif
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	TAtomic<bool> bStop{ false };
+	TAtomic<bool> bRecording{ false };
+	TAtomic<uint64> BytesWritten{ 0 };
+
+	/** Chunk size that triggers a write, and how often partial chunks are written (seconds) */
+	static constexpr int32 ChunkBytes = 256 * 1024;
+	static constexpr double FlushInterval = 0.05;
+
+	/** Minimum size of the mapped window; the file grows by this much at a time */
+	static constexpr uint64 MapWindowBytes = 16 * 1024 * 1024;
+};
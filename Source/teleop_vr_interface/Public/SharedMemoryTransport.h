@@ -0,0 +1,175 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "ITransport.h"
+#include "PacketDemux.h"
+
+class FSessionRecordLane;
+
+// POSIX shared memory and futex wake-ups are only wired up on Linux-based platforms
+#ifndef SHAREDMEMORYTRANSPORT_AVAILABLE
+#define SHAREDMEMORYTRANSPORT_AVAILABLE (PLATFORM_LINUX || PLATFORM_ANDROID)
+#endif
+
+// ============================================================================
+// Shared segment layout (native endianness, both sides on the same host)
+//
+//   FShmSegmentHeader
+//   FShmRingControl  [ToSimulator]
+//   FShmRingControl  [ToOperator]
+//   ring data        [ToSimulator], RingBytes
+//   ring data        [ToOperator],  RingBytes
+//
+// Each ring is a single-producer single-consumer byte ring of datagrams, each
+// stored as { uint32 Size, uint32 Reserved, payload, pad to 8 }. A datagram never
+// wraps: when it does not fit before the end of the ring, Size = WrapMarker
+// skips the rest. Head and Tail are byte counters that only grow.
+//
+// A consumer with nothing to read increments Waiters and sleeps on a futex on
+// Signal; a producer increments Signal after publishing and only issues the wake
+// syscall if someone is waiting.
+// ============================================================================
+
+namespace ShmSegment
+{
+	static constexpr uint32 Magic = 0x4D484554;		// "TEHM"
+	static constexpr uint32 Version = 1;
+	static constexpr uint32 WrapMarker = 0xFFFFFFFFu;
+	static constexpr uint32 RecordHeaderBytes = 8;
+	static constexpr uint32 Alignment = 8;
+
+	enum ERing : int32
+	{
+		ToSimulator = 0,
+		ToOperator = 1,
+		NumRings = 2
+	};
+
+	inline uint32 AlignUp(uint32 Size) { return (Size + Alignment - 1) & ~(Alignment - 1); }
+}
+
+struct FShmSegmentHeader
+{
+	volatile uint32 Magic;		// stored last by the creator, once the segment is initialized
+	uint32 Version;
+	uint32 RingBytes;			// power of two
+	uint32 MaxDatagramBytes;
+	uint8 Reserved[48];
+};
+
+struct FShmRingControl
+{
+	alignas(64) volatile int64 Head;	// written by the producer
+	alignas(64) volatile int64 Tail;	// written by the consumer
+	alignas(64) volatile int32 Signal;	// futex word, bumped on every publish
+	volatile int32 Waiters;				// consumers asleep on Signal
+};
+
+static_assert(sizeof(FShmSegmentHeader) == 64, "Shared segment header layout changed");
+static_assert(sizeof(FShmRingControl) == 192, "Shared ring control layout changed");
+
+/**
+ * Transport for a simulator on the same host: datagrams are exchanged through a
+ * pair of rings in a POSIX shared-memory segment instead of UDP loopback, which
+ * saves the socket syscalls and kernel copies on both sides.
+ *
+ * Selected by setting UComLink's RemoteIP to "shm://<name>"; the segment is
+ * /dev/shm/<name>. Whichever side starts first creates and initializes it, the
+ * other attaches. The segment is left in place on shutdown so either side can
+ * restart; delete it to change the ring size.
+ *
+ * Semantics match UDP: sends never block, and a datagram that does not fit
+ * into a full ring is dropped and counted.
+ */
+class FSharedMemoryTransport : public ITransport, public FRunnable
+{
+public:
+	/** Attach to, or create, segment Name with rings of at least RingBytes each (at most 1 GiB) */
+	FSharedMemoryTransport(const FString& InName, SIZE_T InRingBytes);
+	virtual ~FSharedMemoryTransport();
+
+	/** True if the segment is mapped */
+	bool IsOpen() const { return Segment != nullptr; }
+
+	/** Datagrams dropped because the simulator's ring was full */
+	uint32 GetSendOverflowCount() const { return SendOverflows.Load(); }
+
+	// ITransport
+	virtual void stop() override;
+	virtual bool send_raw(const uint8* Data, int32 Size) override;
+	virtual void queue_send(const uint8* Data, int32 Size) override;
+	virtual bool flush_sends() override;
+	virtual bool send_batch(const uint8* Data, const int32* Sizes, int32 Count) override;
+	/** Every endpoint behind this segment is served by the one simulator process attached to it */
+	virtual void set_endpoint_address(uint8 Endpoint, const FString& Ip, int32 Port) override {}
+	virtual bool has_new_data() const override { return Demux.HasNewData(); }
+	virtual void drain(TFunctionRef<void(const FRawPacket&)> Visitor) override { Demux.Drain(Visitor); }
+	virtual void enable_queue(uint8 MsgType, int32 Capacity) override { Demux.EnableQueue(MsgType, Capacity); }
+	virtual void set_receive_observer(TFunction<void(uint8 Endpoint, uint8 MsgType, const uint8* Data, int32 Size, double ReceiveTime)> Observer) override
+	{
+		Demux.SetObserver(MoveTemp(Observer));
+	}
+	virtual void set_recorder(FSessionRecorder* Recorder) override;
+	virtual uint32 get_dropped_count() const override { return Demux.GetDroppedCount(); }
+	virtual uint32 get_dropped_count(uint8 Endpoint, uint8 MsgType) const override { return Demux.GetDroppedCount(Endpoint, MsgType); }
+	virtual bool isConnectionAlive() const override;
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	static constexpr int32 MaxDatagramBytes = 4096;
+
+private:
+	bool OpenSegment();
+	void CloseSegment();
+
+	/** Copy datagrams into the simulator's ring and wake it once. Caller holds SendLock. */
+	bool Write(const uint8* Data, const int32* Sizes, int32 Count);
+
+	/** Dispatch every datagram in our ring. Returns false if it was empty. */
+	bool ReadAvailable();
+
+	/** Block until our ring has data, Stop() is called, or the timeout passes */
+	void WaitForData();
+
+	void Wake(FShmRingControl& Control);
+	void Record(FSessionRecordLane* Lane, const uint8* Data, const int32* Sizes, int32 Count);
+
+	FString Name;
+	SIZE_T RequestedRingBytes = 0;
+
+	uint8* Segment = nullptr;
+	uint64 SegmentBytes = 0;
+	uint32 RingBytes = 0;
+	FShmRingControl* Controls = nullptr;
+	uint8* RingData[ShmSegment::NumRings] = {};
+
+	// Send: the game thread and one sender thread may both write to the simulator's ring
+	FCriticalSection SendLock;
+	static constexpr int32 MaxSendBatch = 16;
+	TArray<uint8> SendBatchData;
+	TArray<int32, TInlineAllocator<MaxSendBatch>> SendBatchSizes;
+	TAtomic<uint32> SendOverflows{ 0 };
+
+	// Receive
+	FPacketDemux Demux;
+	FRunnableThread* ReceiverThread = nullptr;
+	TAtomic<bool> bStop{ false };
+	TAtomic<double> LastReceiveTime{ 0.0 };
+
+	/** Poll before sleeping, so a steady stream is picked up without a wake-up syscall on either side */
+	static constexpr double SpinBeforeWaitSeconds = 50e-6;
+	double SpinSeconds = 0.0;
+
+	/** Upper bound on one futex wait, so a lost wake-up only delays the next check */
+	static constexpr int32 WaitTimeoutMs = 100;
+
+	// Session recording: one lane per thread (receive, game-thread sends, send_batch callers)
+	FSessionRecordLane* RecvRecordLane = nullptr;
+	FSessionRecordLane* SendRecordLane = nullptr;
+	FSessionRecordLane* BatchRecordLane = nullptr;
+	TAtomic<bool> bRecording{ false };
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StreamStats.generated.h"
+
+// ============================================================================
+// Per-stream sequence tracking for inbound ComLink traffic.
+// The simulator numbers each stream independently; a packet whose sequence is
+// not newer than the last accepted one is stale and is dropped.
+// ============================================================================
+
+/** Inbound streams with their own sequence space. Robot-state deltas share their arm's stream. */
+UENUM(BlueprintType)
+enum class EComStream : uint8
+{
+	RobotStateRight,
+	RobotStateLeft,
+	PanTilt,
+	SystemStatus,
+	Count UMETA(Hidden),
+};
+
+USTRUCT(BlueprintType)
+struct FComStreamStats
+{
+	GENERATED_BODY()
+
+	/** Packets accepted (in order, first copy) */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	int32 Received = 0;
+
+	/** Sequence numbers that never arrived, excluding packets dropped locally */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	int32 Lost = 0;
+
+	/** Packets that arrived but were superseded in the receive mailbox before the game thread read them */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	int32 Superseded = 0;
+
+	/** Second copies of an already accepted sequence number (dropped) */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	int32 Duplicates = 0;
+
+	/** Packets that arrived after a newer one had been accepted (dropped) */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	int32 Reordered = 0;
+
+	/** Number of discontinuities, and the longest one in sequence numbers */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	int32 Gaps = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	int32 MaxGap = 0;
+
+	/** Times the sequence restarted (remote restart or long outage) */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	int32 Resyncs = 0;
+
+	/** Network loss since the last reset, and over roughly the last 64 packets */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	float LossPercent = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	float RecentLossPercent = 0.0f;
+
+	/** Smoothed time between accepted packets, its mean deviation, and the longest silence */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	float MeanInterArrivalMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	float InterArrivalJitterMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	float MaxInterArrivalMs = 0.0f;
+
+	/** Inter-arrival counts, bucket upper edges in ms: 1, 2, 5, 10, 20, 50, 100, 200, 500, inf */
+	UPROPERTY(BlueprintReadOnly, Category = "ComLink|Stats")
+	TArray<int32> InterArrivalHistogram;
+};
+
+/**
+ * Classifies each packet of one stream by sequence number and keeps FComStreamStats.
+ * Not thread safe: each instance belongs to the thread that feeds it (the game thread
+ * for ComLink's streams, the receive thread for FRobotStateTelemetry).
+ */
+class FSequenceTracker
+{
+public:
+	enum class EVerdict : uint8
+	{
+		Accept,
+		Duplicate,
+		Stale,
+	};
+
+	static constexpr int32 NumHistogramBuckets = 10;
+	static const float HistogramEdgesMs[NumHistogramBuckets - 1];
+
+	FSequenceTracker() { Reset(); }
+
+	/**
+	 * Classify a packet. LocalDrops is the running count of packets of this stream
+	 * dropped by the receive mailbox; gaps they explain are not counted as loss.
+	 */
+	EVerdict Observe(uint32 Sequence, double ReceiveTime, uint32 LocalDrops);
+
+	const FComStreamStats& GetStats() const { return Stats; }
+
+	/** Accept the next packet as the new start of the sequence, keeping the statistics (e.g. a replay looping) */
+	void Restart() { bStarted = false; }
+
+	void Reset();
+
+private:
+	void RecordArrival(double ReceiveTime);
+	void UpdateLoss();
+	void Resync(uint32 Sequence);
+
+	/** Older packets are treated as out of window; this many in a row mean the sequence restarted */
+	static constexpr int32 ReorderWindow = 64;
+	static constexpr int32 ResyncAfterStale = 3;
+	static constexpr float RecentLossAlpha = 1.0f / 64.0f;
+
+	FComStreamStats Stats;
+
+	bool bStarted = false;
+	uint32 Highest = 0;
+	uint64 ReceivedMask = 0;	// bit i set: Highest - i was accepted
+	uint64 LostMask = 0;		// bit i set: Highest - i is counted in Stats.Lost
+	int32 ConsecutiveStale = 0;
+
+	uint32 LastLocalDrops = 0;
+	uint32 PendingLocalDrops = 0;
+
+	double LastArrival = -1.0;
+	double RecentLoss = 0.0;
+};
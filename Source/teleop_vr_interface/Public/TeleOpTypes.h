@@ -9,7 +9,7 @@
 // Message type identifiers
 // 0x0_ : Operator -> Simulator
 // 0x1_ : Simulator -> Operator
-// 0x2_ : Configuration (bidirectional, TCP)
+// 0x2_ : Configuration and link control (bidirectional)
 // ============================================================================
 enum class EMsgType : uint8
 {
@@ -18,15 +18,25 @@ enum class EMsgType : uint8
 	HandLeft = 0x02,
 	HandRight = 0x03,
 	ModeCommand = 0x04,
+	StateAck = 0x05,		// acknowledges a robot-state keyframe (enables delta streams)
 
 	// Simulator -> Operator
 	RobotStateRight = 0x10,
 	RobotStateLeft = 0x11,
 	PanTiltState = 0x12,
 	SystemStatus = 0x13,
+	RobotStateDeltaRight = 0x14,	// compact encoding only
+	RobotStateDeltaLeft = 0x15,		// compact encoding only
 
-	// Configuration (future TCP)
-	ConfigUpdate = 0x20,
+	// Configuration (reliable: acknowledged and retransmitted)
+	ConfigUpdate = 0x20,	// Operator -> Simulator
+
+	// Clock synchronization (UDP)
+	TimeSyncPing = 0x21,	// Operator -> Simulator
+	TimeSyncPong = 0x22,	// Simulator -> Operator, echoes the ping's timestamp
+
+	// Reliable channel
+	CommandAck = 0x23,		// Simulator -> Operator, confirms a ModeCommand / ConfigUpdate by (type, seq)
 };
 
 // ============================================================================
@@ -42,6 +52,20 @@ enum class EOpMode : uint8
 	Error = 5,
 };
 
+// ============================================================================
+// Wire encodings
+// Msgpack is the reference protocol. Compact is a fixed little-endian layout with
+// float32 fields, roughly half the size. Inbound packets are always accepted in
+// either encoding (the first byte tells them apart).
+// ============================================================================
+UENUM(BlueprintType)
+enum class EWireEncoding : uint8
+{
+	Msgpack,
+	Compact,
+	Auto,		// Msgpack until the remote sends a compact packet, then Compact
+};
+
 // ============================================================================
 // Robot status flags (bitfield)
 // ============================================================================
@@ -75,6 +99,184 @@ struct FTrackedPose
 	double Timestamp = 0.0;
 };
 
+// ============================================================================
+// Fixed-capacity msgpack output stream (no heap allocation)
+// Each wire struct sizes it from its worst-case encoded length, so the hot
+// send path can pack straight into a stack buffer.
+// ============================================================================
+template<int32 Capacity>
+struct TWireBuffer
+{
+	char Data[Capacity];
+	int32 Size = 0;
+	bool bOverflow = false;
+
+	// msgpack stream interface
+	void write(const char* Buf, size_t Len)
+	{
+		if (Size + static_cast<int32>(Len) > Capacity)
+		{
+			bOverflow = true;
+			return;
+		}
+		FMemory::Memcpy(Data + Size, Buf, Len);
+		Size += static_cast<int32>(Len);
+	}
+
+	void Reset() { Size = 0; bOverflow = false; }
+
+	const uint8* GetData() const { return reinterpret_cast<const uint8*>(Data); }
+	int32 Num() const { return Size; }
+};
+
+// Worst-case msgpack encodings
+namespace WireSize
+{
+	constexpr int32 ArrayHeader = 1;	// fixarray, up to 15 elements
+	constexpr int32 UInt8 = 2;
+	constexpr int32 UInt32 = 5;
+	constexpr int32 UInt64 = 9;
+	constexpr int32 Double = 9;
+}
+
+// ============================================================================
+// Compact binary encoding
+// Header: [magic u8][type u8][flags u8][seq u32][timestamp u64], then the
+// struct's fields in declaration order, float32 for all real values.
+// All multi-byte values are little-endian.
+// ============================================================================
+namespace CompactWire
+{
+	constexpr uint8 Magic = 0xC1;				// reserved in msgpack, never starts a msgpack packet
+	constexpr uint8 FlagSmallestThree = 0x01;	// orientation packed as smallest-three (u32)
+	constexpr int32 HeaderSize = 3 + 4 + 8;
+	constexpr int32 Float = 4;
+	constexpr int32 FullQuat = 4 * Float;
+	constexpr int32 PackedQuat = 4;
+
+	inline bool IsCompact(const uint8* Data, int32 Size)
+	{
+		return Size > 0 && Data[0] == Magic;
+	}
+
+	template<typename Stream>
+	void PutLE(Stream& Out, uint64 Value, int32 Bytes)
+	{
+		char Tmp[8];
+		for (int32 i = 0; i < Bytes; ++i) Tmp[i] = static_cast<char>((Value >> (8 * i)) & 0xFF);
+		Out.write(Tmp, Bytes);
+	}
+
+	template<typename Stream>
+	void PutFloat(Stream& Out, double Value)
+	{
+		const float F = static_cast<float>(Value);
+		uint32 Bits;
+		FMemory::Memcpy(&Bits, &F, sizeof(Bits));
+		PutLE(Out, Bits, 4);
+	}
+
+	template<typename Stream>
+	void PutHeader(Stream& Out, uint8 Type, uint8 Flags, uint32 Sequence, uint64 Timestamp)
+	{
+		PutLE(Out, Magic, 1);
+		PutLE(Out, Type, 1);
+		PutLE(Out, Flags, 1);
+		PutLE(Out, Sequence, 4);
+		PutLE(Out, Timestamp, 8);
+	}
+
+	// Smallest-three: drop the largest component (recoverable from unit length),
+	// send its index in 2 bits and the other three in 10 bits each.
+	constexpr double SmallestThreeRange = 0.70710678118654752;	// 1/sqrt(2)
+
+	inline uint32 EncodeSmallestThree(double QX, double QY, double QZ, double QW)
+	{
+		double Q[4] = { QX, QY, QZ, QW };
+		int32 Largest = 0;
+		for (int32 i = 1; i < 4; ++i)
+		{
+			if (FMath::Abs(Q[i]) > FMath::Abs(Q[Largest])) Largest = i;
+		}
+		const double Sign = Q[Largest] < 0.0 ? -1.0 : 1.0;	// q and -q are the same rotation
+
+		uint32 Packed = static_cast<uint32>(Largest) << 30;
+		int32 Shift = 20;
+		for (int32 i = 0; i < 4; ++i)
+		{
+			if (i == Largest) continue;
+			const double Normalized = FMath::Clamp(Sign * Q[i] / SmallestThreeRange, -1.0, 1.0);
+			const uint32 Quantized = static_cast<uint32>(FMath::RoundToInt((Normalized * 0.5 + 0.5) * 1023.0));
+			Packed |= Quantized << Shift;
+			Shift -= 10;
+		}
+		return Packed;
+	}
+
+	inline void DecodeSmallestThree(uint32 Packed, double& QX, double& QY, double& QZ, double& QW)
+	{
+		double Q[4];
+		const int32 Largest = static_cast<int32>(Packed >> 30);
+		double SumSquares = 0.0;
+		int32 Shift = 20;
+		for (int32 i = 0; i < 4; ++i)
+		{
+			if (i == Largest) continue;
+			const double Quantized = static_cast<double>((Packed >> Shift) & 0x3FF);
+			Q[i] = (Quantized / 1023.0 * 2.0 - 1.0) * SmallestThreeRange;
+			SumSquares += Q[i] * Q[i];
+			Shift -= 10;
+		}
+		Q[Largest] = FMath::Sqrt(FMath::Max(0.0, 1.0 - SumSquares));
+		QX = Q[0]; QY = Q[1]; QZ = Q[2]; QW = Q[3];
+	}
+
+	template<typename Stream>
+	void PutQuat(Stream& Out, bool bSmallestThree, double QX, double QY, double QZ, double QW)
+	{
+		if (bSmallestThree)
+		{
+			PutLE(Out, EncodeSmallestThree(QX, QY, QZ, QW), 4);
+		}
+		else
+		{
+			PutFloat(Out, QX); PutFloat(Out, QY); PutFloat(Out, QZ); PutFloat(Out, QW);
+		}
+	}
+}
+
+// ============================================================================
+// Endpoint envelope: [tag u8][endpoint u8] in front of an unchanged message,
+// for one operator station driving several robots or camera heads over one
+// socket. Endpoint 0 (the primary) is sent without the envelope, so a remote
+// that only knows a single endpoint never sees it.
+// ============================================================================
+namespace EndpointWire
+{
+	constexpr uint8 Tag = 0xC2;			// msgpack false: never starts a message in either encoding
+	constexpr int32 HeaderSize = 2;
+	constexpr int32 MaxEndpoints = 8;
+
+	/** Endpoint a datagram is addressed to, without validating it */
+	inline uint8 Peek(const uint8* Data, int32 Size)
+	{
+		return (Size >= HeaderSize && Data[0] == Tag) ? Data[1] : 0;
+	}
+
+	/** Strip the envelope, if any. False if it is truncated or names an endpoint out of range. */
+	inline bool Split(const uint8*& Data, int32& Size, uint8& OutEndpoint)
+	{
+		OutEndpoint = 0;
+		if (Size <= 0 || Data[0] != Tag) return true;
+		if (Size < HeaderSize || Data[1] >= MaxEndpoints) return false;
+
+		OutEndpoint = Data[1];
+		Data += HeaderSize;
+		Size -= HeaderSize;
+		return true;
+	}
+}
+
 // ============================================================================
 // Wire-format structs (protocol convention: meters, right-handed, Z-up, quaternions)
 // These represent exactly what goes on the wire.
@@ -91,13 +293,15 @@ struct FWirePose
 	double	QX = 0, QY = 0, QZ = 0, QW = 1.0;
 	double	TriggerValue = 0.0;		// only used for hand messages
 
+	static constexpr int32 MaxPackedSize =
+		WireSize::ArrayHeader + WireSize::UInt64 + WireSize::UInt32 + WireSize::UInt8 + 8 * WireSize::Double;
+	using FPackBuffer = TWireBuffer<MaxPackedSize>;
+
 	// Pack as flat msgpack array: [ts, seq, type, px, py, pz, qx, qy, qz, qw]
 	// For hand messages appends trigger: [ts, seq, type, px, py, pz, qx, qy, qz, qw, trigger]
-	msgpack::sbuffer Pack() const
+	template<typename Stream>
+	void PackTo(msgpack::packer<Stream>& pk) const
 	{
-		msgpack::sbuffer buf;
-		msgpack::packer<msgpack::sbuffer> pk(&buf);
-
 		bool bIsHand = (Type == static_cast<uint8>(EMsgType::HandLeft) ||
 			Type == static_cast<uint8>(EMsgType::HandRight));
 		pk.pack_array(bIsHand ? 11 : 10);
@@ -107,9 +311,41 @@ struct FWirePose
 		pk.pack(PX); pk.pack(PY); pk.pack(PZ);
 		pk.pack(QX); pk.pack(QY); pk.pack(QZ); pk.pack(QW);
 		if (bIsHand) pk.pack(TriggerValue);
+	}
 
+	msgpack::sbuffer Pack() const
+	{
+		msgpack::sbuffer buf;
+		msgpack::packer<msgpack::sbuffer> pk(&buf);
+		PackTo(pk);
 		return buf;
 	}
+
+	// Allocation-free variant: packs into a caller-owned fixed buffer
+	void Pack(FPackBuffer& Out) const
+	{
+		Out.Reset();
+		msgpack::packer<FPackBuffer> pk(&Out);
+		PackTo(pk);
+	}
+
+	static constexpr int32 MaxCompactSize =
+		CompactWire::HeaderSize + 3 * CompactWire::Float + CompactWire::FullQuat + CompactWire::Float;
+	using FCompactBuffer = TWireBuffer<MaxCompactSize>;
+
+	// Compact: [header][px, py, pz][quat][trigger (hands only)]
+	void PackCompact(FCompactBuffer& Out, bool bSmallestThree) const
+	{
+		Out.Reset();
+		CompactWire::PutHeader(Out, Type, bSmallestThree ? CompactWire::FlagSmallestThree : 0, Sequence, Timestamp);
+		CompactWire::PutFloat(Out, PX); CompactWire::PutFloat(Out, PY); CompactWire::PutFloat(Out, PZ);
+		CompactWire::PutQuat(Out, bSmallestThree, QX, QY, QZ, QW);
+
+		if (Type == static_cast<uint8>(EMsgType::HandLeft) || Type == static_cast<uint8>(EMsgType::HandRight))
+		{
+			CompactWire::PutFloat(Out, TriggerValue);
+		}
+	}
 };
 
 struct FWireModeCommand
@@ -118,19 +354,399 @@ struct FWireModeCommand
 	uint32	Sequence = 0;
 	uint8	Mode = 0;
 
-	msgpack::sbuffer Pack() const
-	{
-		msgpack::sbuffer buf;
-		msgpack::packer<msgpack::sbuffer> pk(&buf);
+	static constexpr int32 MaxPackedSize =
+		WireSize::ArrayHeader + WireSize::UInt64 + WireSize::UInt32 + 2 * WireSize::UInt8;
+	using FPackBuffer = TWireBuffer<MaxPackedSize>;
 
+	// [ts, seq, type, mode]
+	template<typename Stream>
+	void PackTo(msgpack::packer<Stream>& pk) const
+	{
 		pk.pack_array(4);
 		pk.pack(Timestamp);
 		pk.pack(Sequence);
 		pk.pack(static_cast<uint8>(EMsgType::ModeCommand));
 		pk.pack(Mode);
+	}
 
+	msgpack::sbuffer Pack() const
+	{
+		msgpack::sbuffer buf;
+		msgpack::packer<msgpack::sbuffer> pk(&buf);
+		PackTo(pk);
 		return buf;
 	}
+
+	// Allocation-free variant: packs into a caller-owned fixed buffer
+	void Pack(FPackBuffer& Out) const
+	{
+		Out.Reset();
+		msgpack::packer<FPackBuffer> pk(&Out);
+		PackTo(pk);
+	}
+
+	static constexpr int32 MaxCompactSize = CompactWire::HeaderSize + 1;
+	using FCompactBuffer = TWireBuffer<MaxCompactSize>;
+
+	// Compact: [header][mode]
+	void PackCompact(FCompactBuffer& Out) const
+	{
+		Out.Reset();
+		CompactWire::PutHeader(Out, static_cast<uint8>(EMsgType::ModeCommand), 0, Sequence, Timestamp);
+		CompactWire::PutLE(Out, Mode, 1);
+	}
+};
+
+struct FWireStateAck
+{
+	uint64	Timestamp = 0;
+	uint32	Sequence = 0;
+	uint8	StateType = 0;			// RobotStateRight / RobotStateLeft
+	uint32	KeyframeSequence = 0;	// sequence of the keyframe now held by the operator
+
+	static constexpr int32 MaxPackedSize =
+		WireSize::ArrayHeader + WireSize::UInt64 + 2 * WireSize::UInt32 + 2 * WireSize::UInt8;
+	using FPackBuffer = TWireBuffer<MaxPackedSize>;
+
+	// [ts, seq, type, state_type, keyframe_seq]
+	void Pack(FPackBuffer& Out) const
+	{
+		Out.Reset();
+		msgpack::packer<FPackBuffer> pk(&Out);
+		pk.pack_array(5);
+		pk.pack(Timestamp);
+		pk.pack(Sequence);
+		pk.pack(static_cast<uint8>(EMsgType::StateAck));
+		pk.pack(StateType);
+		pk.pack(KeyframeSequence);
+	}
+
+	static constexpr int32 MaxCompactSize = CompactWire::HeaderSize + 1 + 4;
+	using FCompactBuffer = TWireBuffer<MaxCompactSize>;
+
+	// Compact: [header][state_type u8][keyframe_seq u32]
+	void PackCompact(FCompactBuffer& Out) const
+	{
+		Out.Reset();
+		CompactWire::PutHeader(Out, static_cast<uint8>(EMsgType::StateAck), 0, Sequence, Timestamp);
+		CompactWire::PutLE(Out, StateType, 1);
+		CompactWire::PutLE(Out, KeyframeSequence, 4);
+	}
+};
+
+// Generic parameter update, sent over the reliable channel. Keys are agreed with
+// the simulator; the operator side does not interpret them.
+struct FWireConfigUpdate
+{
+	uint64	Timestamp = 0;
+	uint32	Sequence = 0;
+	uint16	Key = 0;
+	double	Value = 0.0;
+
+	static constexpr int32 MaxPackedSize =
+		WireSize::ArrayHeader + WireSize::UInt64 + 2 * WireSize::UInt32 + WireSize::UInt8 + WireSize::Double;
+	using FPackBuffer = TWireBuffer<MaxPackedSize>;
+
+	// [ts, seq, type, key, value]
+	void Pack(FPackBuffer& Out) const
+	{
+		Out.Reset();
+		msgpack::packer<FPackBuffer> pk(&Out);
+		pk.pack_array(5);
+		pk.pack(Timestamp);
+		pk.pack(Sequence);
+		pk.pack(static_cast<uint8>(EMsgType::ConfigUpdate));
+		pk.pack(Key);
+		pk.pack(Value);
+	}
+
+	static constexpr int32 MaxCompactSize = CompactWire::HeaderSize + 2 + CompactWire::Float;
+	using FCompactBuffer = TWireBuffer<MaxCompactSize>;
+
+	// Compact: [header][key u16][value]
+	void PackCompact(FCompactBuffer& Out) const
+	{
+		Out.Reset();
+		CompactWire::PutHeader(Out, static_cast<uint8>(EMsgType::ConfigUpdate), 0, Sequence, Timestamp);
+		CompactWire::PutLE(Out, Key, 2);
+		CompactWire::PutFloat(Out, Value);
+	}
+};
+
+// NTP-style clock probe. The simulator answers each ping with a TimeSyncPong
+// carrying the ping's timestamp plus its own receive and transmit times.
+struct FWireTimeSyncPing
+{
+	uint64	Timestamp = 0;			// operator clock at transmit (t0)
+	uint32	Sequence = 0;
+
+	static constexpr int32 MaxPackedSize =
+		WireSize::ArrayHeader + WireSize::UInt64 + WireSize::UInt32 + WireSize::UInt8;
+	using FPackBuffer = TWireBuffer<MaxPackedSize>;
+
+	// [ts, seq, type]
+	void Pack(FPackBuffer& Out) const
+	{
+		Out.Reset();
+		msgpack::packer<FPackBuffer> pk(&Out);
+		pk.pack_array(3);
+		pk.pack(Timestamp);
+		pk.pack(Sequence);
+		pk.pack(static_cast<uint8>(EMsgType::TimeSyncPing));
+	}
+
+	static constexpr int32 MaxCompactSize = CompactWire::HeaderSize;
+	using FCompactBuffer = TWireBuffer<MaxCompactSize>;
+
+	// Compact: [header]
+	void PackCompact(FCompactBuffer& Out) const
+	{
+		Out.Reset();
+		CompactWire::PutHeader(Out, static_cast<uint8>(EMsgType::TimeSyncPing), 0, Sequence, Timestamp);
+	}
+};
+
+// ============================================================================
+// Streaming msgpack reader for incoming messages
+// Decodes directly from the datagram: no zone allocation, no object tree, no
+// exceptions. The first failure is latched and returned as a result code.
+// ============================================================================
+enum class EWireDecodeResult : uint8
+{
+	Ok,
+	Truncated,		// buffer ends mid-element
+	NotArray,		// top level is not a msgpack array
+	TooShort,		// array has fewer elements than the layout needs
+	TypeMismatch,	// element has the wrong msgpack type or is out of range
+	UnknownEncoding,	// neither msgpack nor compact
+};
+
+inline const TCHAR* LexToString(EWireDecodeResult Result)
+{
+	switch (Result)
+	{
+	case EWireDecodeResult::Ok:				return TEXT("Ok");
+	case EWireDecodeResult::Truncated:		return TEXT("Truncated");
+	case EWireDecodeResult::NotArray:		return TEXT("NotArray");
+	case EWireDecodeResult::TooShort:		return TEXT("TooShort");
+	case EWireDecodeResult::TypeMismatch:	return TEXT("TypeMismatch");
+	case EWireDecodeResult::UnknownEncoding:	return TEXT("UnknownEncoding");
+	default:								return TEXT("Unknown");
+	}
+}
+
+class FWireReader
+{
+public:
+	FWireReader(const uint8* InData, int32 InSize) : Data(InData), Size(InSize) {}
+
+	EWireDecodeResult GetResult() const { return Result; }
+
+	/** Read the top-level array header, requiring at least MinCount elements */
+	bool ReadArray(uint32 MinCount)
+	{
+		if (!Need(1)) return false;
+		const uint8 Tag = Data[Pos++];
+
+		uint32 Count = 0;
+		if ((Tag & 0xF0) == 0x90)	Count = Tag & 0x0F;
+		else if (Tag == 0xDC)		{ if (!Need(2)) return false; Count = static_cast<uint32>(ReadBigEndian(2)); }
+		else if (Tag == 0xDD)		{ if (!Need(4)) return false; Count = static_cast<uint32>(ReadBigEndian(4)); }
+		else return Fail(EWireDecodeResult::NotArray);
+
+		return Count >= MinCount ? true : Fail(EWireDecodeResult::TooShort);
+	}
+
+	/** Unsigned integer that must fit in T */
+	template<typename T>
+	bool ReadUInt(T& Out)
+	{
+		uint64 Bits = 0;
+		bool bSigned = false;
+		if (!ReadInteger(Bits, bSigned)) return false;
+		if ((bSigned && static_cast<int64>(Bits) < 0) || Bits > static_cast<uint64>(TNumericLimits<T>::Max()))
+		{
+			return Fail(EWireDecodeResult::TypeMismatch);
+		}
+		Out = static_cast<T>(Bits);
+		return true;
+	}
+
+	/** float64, float32 or integer, converted to double */
+	bool ReadDouble(double& Out)
+	{
+		if (!Need(1)) return false;
+		const uint8 Tag = Data[Pos];
+
+		if (Tag == 0xCB)
+		{
+			++Pos;
+			if (!Need(8)) return false;
+			const uint64 Bits = ReadBigEndian(8);
+			FMemory::Memcpy(&Out, &Bits, sizeof(Out));
+			return true;
+		}
+		if (Tag == 0xCA)
+		{
+			++Pos;
+			if (!Need(4)) return false;
+			const uint32 Bits = static_cast<uint32>(ReadBigEndian(4));
+			float Value;
+			FMemory::Memcpy(&Value, &Bits, sizeof(Value));
+			Out = Value;
+			return true;
+		}
+
+		uint64 Bits = 0;
+		bool bSigned = false;
+		if (!ReadInteger(Bits, bSigned)) return false;
+		Out = bSigned ? static_cast<double>(static_cast<int64>(Bits)) : static_cast<double>(Bits);
+		return true;
+	}
+
+	/** Message type byte (third element) without decoding the rest */
+	static bool PeekType(const uint8* InData, int32 InSize, uint8& OutType)
+	{
+		if (CompactWire::IsCompact(InData, InSize))
+		{
+			if (InSize < CompactWire::HeaderSize) return false;
+			OutType = InData[1];
+			return true;
+		}
+
+		FWireReader R(InData, InSize);
+		uint64 Skip = 0;
+		return R.ReadArray(3) && R.ReadUInt(Skip) && R.ReadUInt(Skip) && R.ReadUInt(OutType);
+	}
+
+private:
+	bool Fail(EWireDecodeResult InResult)
+	{
+		if (Result == EWireDecodeResult::Ok) Result = InResult;
+		return false;
+	}
+
+	bool Need(int32 Bytes)
+	{
+		return (Result == EWireDecodeResult::Ok && Pos + Bytes <= Size) ? true : Fail(EWireDecodeResult::Truncated);
+	}
+
+	uint64 ReadBigEndian(int32 Bytes)
+	{
+		uint64 Value = 0;
+		for (int32 i = 0; i < Bytes; ++i) Value = (Value << 8) | Data[Pos++];
+		return Value;
+	}
+
+	// Any msgpack integer. Signed values are returned sign-extended in OutBits.
+	bool ReadInteger(uint64& OutBits, bool& bOutSigned)
+	{
+		if (!Need(1)) return false;
+		const uint8 Tag = Data[Pos++];
+
+		if (Tag <= 0x7F) { OutBits = Tag; bOutSigned = false; return true; }
+		if (Tag >= 0xE0) { OutBits = static_cast<uint64>(static_cast<int64>(static_cast<int8>(Tag))); bOutSigned = true; return true; }
+
+		int32 Bytes = 0;
+		switch (Tag)
+		{
+		case 0xCC: case 0xD0: Bytes = 1; break;
+		case 0xCD: case 0xD1: Bytes = 2; break;
+		case 0xCE: case 0xD2: Bytes = 4; break;
+		case 0xCF: case 0xD3: Bytes = 8; break;
+		default: --Pos; return Fail(EWireDecodeResult::TypeMismatch);
+		}
+		if (!Need(Bytes)) return false;
+
+		OutBits = ReadBigEndian(Bytes);
+		bOutSigned = Tag >= 0xD0;
+		if (bOutSigned && Bytes < 8)
+		{
+			const int32 Shift = 64 - 8 * Bytes;
+			OutBits = static_cast<uint64>(static_cast<int64>(OutBits << Shift) >> Shift);
+		}
+		return true;
+	}
+
+	const uint8* Data = nullptr;
+	int32 Size = 0;
+	int32 Pos = 0;
+	EWireDecodeResult Result = EWireDecodeResult::Ok;
+};
+
+/**
+ * Reader for the compact encoding. Same latching semantics as FWireReader.
+ */
+class FCompactReader
+{
+public:
+	FCompactReader(const uint8* InData, int32 InSize) : Data(InData), Size(InSize) {}
+
+	EWireDecodeResult GetResult() const { return Result; }
+
+	/** Read the header. Returns false if the packet is not compact. */
+	bool ReadHeader(uint8& OutType, uint8& OutFlags, uint32& OutSequence, uint64& OutTimestamp)
+	{
+		if (!CompactWire::IsCompact(Data, Size)) return Fail(EWireDecodeResult::UnknownEncoding);
+		Pos = 1;
+		OutType = static_cast<uint8>(ReadLE(1));
+		OutFlags = static_cast<uint8>(ReadLE(1));
+		OutSequence = static_cast<uint32>(ReadLE(4));
+		OutTimestamp = ReadLE(8);
+		return Result == EWireDecodeResult::Ok;
+	}
+
+	void ReadUInt8(uint8& Out) { Out = static_cast<uint8>(ReadLE(1)); }
+	void ReadUInt32(uint32& Out) { Out = static_cast<uint32>(ReadLE(4)); }
+	void ReadUInt64(uint64& Out) { Out = ReadLE(8); }
+	void ReadInt16(int16& Out) { Out = static_cast<int16>(static_cast<uint16>(ReadLE(2))); }
+
+	void ReadFloat(double& Out)
+	{
+		const uint32 Bits = static_cast<uint32>(ReadLE(4));
+		float F;
+		FMemory::Memcpy(&F, &Bits, sizeof(F));
+		Out = F;
+	}
+
+	void ReadQuat(uint8 Flags, double& QX, double& QY, double& QZ, double& QW)
+	{
+		if (Flags & CompactWire::FlagSmallestThree)
+		{
+			const uint32 Packed = static_cast<uint32>(ReadLE(4));
+			if (Result == EWireDecodeResult::Ok) CompactWire::DecodeSmallestThree(Packed, QX, QY, QZ, QW);
+		}
+		else
+		{
+			ReadFloat(QX); ReadFloat(QY); ReadFloat(QZ); ReadFloat(QW);
+		}
+	}
+
+private:
+	bool Fail(EWireDecodeResult InResult)
+	{
+		if (Result == EWireDecodeResult::Ok) Result = InResult;
+		return false;
+	}
+
+	// Returns 0 once the buffer is exhausted; the failure is latched
+	uint64 ReadLE(int32 Bytes)
+	{
+		if (Result != EWireDecodeResult::Ok) return 0;
+		if (Pos + Bytes > Size)
+		{
+			Fail(EWireDecodeResult::Truncated);
+			return 0;
+		}
+		uint64 Value = 0;
+		for (int32 i = 0; i < Bytes; ++i) Value |= static_cast<uint64>(Data[Pos++]) << (8 * i);
+		return Value;
+	}
+
+	const uint8* Data = nullptr;
+	int32 Size = 0;
+	int32 Pos = 0;
+	EWireDecodeResult Result = EWireDecodeResult::Ok;
 };
 
 // --- Incoming: Simulator -> Operator ---
@@ -146,22 +762,43 @@ struct FWireRobotState
 	double	GripperWidth = 0.0;
 	uint8	StatusFlags = 0;
 
-	// Unpack from flat msgpack array
-	bool Unpack(const msgpack::object& obj)
-	{
-		if (obj.type != msgpack::type::ARRAY || obj.via.array.size < 19) return false;
-		auto* a = obj.via.array.ptr;
-
-		Timestamp = a[0].as<uint64>();
-		Sequence = a[1].as<uint32>();
-		Type = a[2].as<uint8>();
-		for (int i = 0; i < 7; ++i) JointPositions[i] = a[3 + i].as<double>();
-		EE_PX = a[10].as<double>(); EE_PY = a[11].as<double>(); EE_PZ = a[12].as<double>();
-		EE_QX = a[13].as<double>(); EE_QY = a[14].as<double>();
-		EE_QZ = a[15].as<double>(); EE_QW = a[16].as<double>();
-		GripperWidth = a[17].as<double>();
-		StatusFlags = a[18].as<uint8>();
-		return true;
+	// Decode from flat msgpack array:
+	// [ts, seq, type, j0..j6, px, py, pz, qx, qy, qz, qw, gripper, status]
+	EWireDecodeResult Decode(const uint8* Data, int32 Size)
+	{
+		if (CompactWire::IsCompact(Data, Size)) return DecodeCompact(Data, Size);
+
+		FWireReader R(Data, Size);
+
+		// Reads after the first failure are no-ops, so no per-field checks are needed
+		R.ReadArray(19);
+		R.ReadUInt(Timestamp);
+		R.ReadUInt(Sequence);
+		R.ReadUInt(Type);
+		for (int i = 0; i < 7; ++i) R.ReadDouble(JointPositions[i]);
+		R.ReadDouble(EE_PX); R.ReadDouble(EE_PY); R.ReadDouble(EE_PZ);
+		R.ReadDouble(EE_QX); R.ReadDouble(EE_QY);
+		R.ReadDouble(EE_QZ); R.ReadDouble(EE_QW);
+		R.ReadDouble(GripperWidth);
+		R.ReadUInt(StatusFlags);
+
+		return R.GetResult();
+	}
+
+	// Compact: [header][j0..j6][px, py, pz][quat][gripper][status u8]
+	EWireDecodeResult DecodeCompact(const uint8* Data, int32 Size)
+	{
+		FCompactReader R(Data, Size);
+		uint8 Flags = 0;
+
+		R.ReadHeader(Type, Flags, Sequence, Timestamp);
+		for (int i = 0; i < 7; ++i) R.ReadFloat(JointPositions[i]);
+		R.ReadFloat(EE_PX); R.ReadFloat(EE_PY); R.ReadFloat(EE_PZ);
+		R.ReadQuat(Flags, EE_QX, EE_QY, EE_QZ, EE_QW);
+		R.ReadFloat(GripperWidth);
+		R.ReadUInt8(StatusFlags);
+
+		return R.GetResult();
 	}
 };
 
@@ -172,17 +809,35 @@ struct FWirePanTiltState
 	double	Pan = 0.0;
 	double	Tilt = 0.0;
 
-	bool Unpack(const msgpack::object& obj)
+	// [ts, seq, type, pan, tilt]
+	EWireDecodeResult Decode(const uint8* Data, int32 Size)
 	{
-		if (obj.type != msgpack::type::ARRAY || obj.via.array.size < 5) return false;
-		auto* a = obj.via.array.ptr;
+		if (CompactWire::IsCompact(Data, Size)) return DecodeCompact(Data, Size);
 
-		Timestamp = a[0].as<uint64>();
-		Sequence = a[1].as<uint32>();
-		// a[2] is type, skip
-		Pan = a[3].as<double>();
-		Tilt = a[4].as<double>();
-		return true;
+		FWireReader R(Data, Size);
+		uint8 MsgType = 0;
+
+		R.ReadArray(5);
+		R.ReadUInt(Timestamp);
+		R.ReadUInt(Sequence);
+		R.ReadUInt(MsgType);	// type, skip
+		R.ReadDouble(Pan);
+		R.ReadDouble(Tilt);
+
+		return R.GetResult();
+	}
+
+	// Compact: [header][pan][tilt]
+	EWireDecodeResult DecodeCompact(const uint8* Data, int32 Size)
+	{
+		FCompactReader R(Data, Size);
+		uint8 MsgType = 0, Flags = 0;
+
+		R.ReadHeader(MsgType, Flags, Sequence, Timestamp);
+		R.ReadFloat(Pan);
+		R.ReadFloat(Tilt);
+
+		return R.GetResult();
 	}
 };
 
@@ -194,18 +849,202 @@ struct FWireSystemStatus
 	double	SimFps = 0.0;
 	uint8	ErrorCode = 0;
 
-	bool Unpack(const msgpack::object& obj)
+	// [ts, seq, type, sim_state, sim_fps, error_code]
+	EWireDecodeResult Decode(const uint8* Data, int32 Size)
 	{
-		if (obj.type != msgpack::type::ARRAY || obj.via.array.size < 6) return false;
-		auto* a = obj.via.array.ptr;
+		if (CompactWire::IsCompact(Data, Size)) return DecodeCompact(Data, Size);
 
-		Timestamp = a[0].as<uint64>();
-		Sequence = a[1].as<uint32>();
-		// a[2] is type, skip
-		SimState = a[3].as<uint8>();
-		SimFps = a[4].as<double>();
-		ErrorCode = a[5].as<uint8>();
-		return true;
+		FWireReader R(Data, Size);
+		uint8 MsgType = 0;
+
+		R.ReadArray(6);
+		R.ReadUInt(Timestamp);
+		R.ReadUInt(Sequence);
+		R.ReadUInt(MsgType);	// type, skip
+		R.ReadUInt(SimState);
+		R.ReadDouble(SimFps);
+		R.ReadUInt(ErrorCode);
+
+		return R.GetResult();
+	}
+
+	// Compact: [header][sim_state u8][sim_fps][error_code u8]
+	EWireDecodeResult DecodeCompact(const uint8* Data, int32 Size)
+	{
+		FCompactReader R(Data, Size);
+		uint8 MsgType = 0, Flags = 0;
+
+		R.ReadHeader(MsgType, Flags, Sequence, Timestamp);
+		R.ReadUInt8(SimState);
+		R.ReadFloat(SimFps);
+		R.ReadUInt8(ErrorCode);
+
+		return R.GetResult();
+	}
+};
+
+struct FWireCommandAck
+{
+	uint64	Timestamp = 0;
+	uint32	Sequence = 0;
+	uint8	AckedType = 0;			// ModeCommand / ConfigUpdate
+	uint32	AckedSequence = 0;		// sequence of the command being confirmed
+
+	// [ts, seq, type, acked_type, acked_seq]
+	EWireDecodeResult Decode(const uint8* Data, int32 Size)
+	{
+		if (CompactWire::IsCompact(Data, Size)) return DecodeCompact(Data, Size);
+
+		FWireReader R(Data, Size);
+		uint8 MsgType = 0;
+
+		R.ReadArray(5);
+		R.ReadUInt(Timestamp);
+		R.ReadUInt(Sequence);
+		R.ReadUInt(MsgType);	// type, skip
+		R.ReadUInt(AckedType);
+		R.ReadUInt(AckedSequence);
+
+		return R.GetResult();
+	}
+
+	// Compact: [header][acked_type u8][acked_seq u32]
+	EWireDecodeResult DecodeCompact(const uint8* Data, int32 Size)
+	{
+		FCompactReader R(Data, Size);
+		uint8 MsgType = 0, Flags = 0;
+
+		R.ReadHeader(MsgType, Flags, Sequence, Timestamp);
+		R.ReadUInt8(AckedType);
+		R.ReadUInt32(AckedSequence);
+
+		return R.GetResult();
+	}
+};
+
+struct FWireTimeSyncPong
+{
+	uint64	Timestamp = 0;			// simulator clock at transmit (t2)
+	uint32	Sequence = 0;			// sequence of the ping being answered
+	uint64	OriginTimestamp = 0;	// ping's timestamp, echoed unchanged (t0)
+	uint64	ReceiveTimestamp = 0;	// simulator clock when the ping arrived (t1)
+
+	// [ts, seq, type, origin_ts, receive_ts]
+	EWireDecodeResult Decode(const uint8* Data, int32 Size)
+	{
+		if (CompactWire::IsCompact(Data, Size)) return DecodeCompact(Data, Size);
+
+		FWireReader R(Data, Size);
+		uint8 MsgType = 0;
+
+		R.ReadArray(5);
+		R.ReadUInt(Timestamp);
+		R.ReadUInt(Sequence);
+		R.ReadUInt(MsgType);	// type, skip
+		R.ReadUInt(OriginTimestamp);
+		R.ReadUInt(ReceiveTimestamp);
+
+		return R.GetResult();
+	}
+
+	// Compact: [header][origin_ts u64][receive_ts u64]
+	EWireDecodeResult DecodeCompact(const uint8* Data, int32 Size)
+	{
+		FCompactReader R(Data, Size);
+		uint8 MsgType = 0, Flags = 0;
+
+		R.ReadHeader(MsgType, Flags, Sequence, Timestamp);
+		R.ReadUInt64(OriginTimestamp);
+		R.ReadUInt64(ReceiveTimestamp);
+
+		return R.GetResult();
+	}
+};
+
+// ============================================================================
+// Robot-state delta stream
+// The simulator sends periodic full RobotState keyframes. Once the operator has
+// acknowledged one (StateAck), the states in between may be sent as int16
+// residuals against that keyframe. A delta that references a keyframe the
+// operator does not hold is dropped; the next full state re-synchronises.
+// Residuals that would overflow int16 require the simulator to send a keyframe.
+// ============================================================================
+namespace StateDelta
+{
+	constexpr double JointStep = 1e-4;		// rad,   range +-3.27 rad
+	constexpr double PositionStep = 1e-5;	// m,     range +-0.33 m
+	constexpr double QuatStep = 1e-4;		//        range +-3.27 (covers sign flips)
+	constexpr double GripperStep = 1e-5;	// m,     range +-0.33 m
+
+	inline bool IsDeltaType(uint8 Type)
+	{
+		return Type == static_cast<uint8>(EMsgType::RobotStateDeltaRight) ||
+			Type == static_cast<uint8>(EMsgType::RobotStateDeltaLeft);
+	}
+
+	/** Full-state type that a delta type reconstructs */
+	inline uint8 KeyframeType(uint8 DeltaType)
+	{
+		return DeltaType == static_cast<uint8>(EMsgType::RobotStateDeltaLeft)
+			? static_cast<uint8>(EMsgType::RobotStateLeft)
+			: static_cast<uint8>(EMsgType::RobotStateRight);
+	}
+}
+
+struct FWireRobotStateDelta
+{
+	uint64	Timestamp = 0;
+	uint32	Sequence = 0;
+	uint8	Type = 0;
+	uint32	KeyframeSequence = 0;
+	int16	JointResiduals[7] = {};
+	int16	PositionResiduals[3] = {};
+	int16	QuatResiduals[4] = {};
+	int16	GripperResidual = 0;
+	uint8	StatusFlags = 0;				// sent in full
+
+	// Compact: [header][keyframe_seq u32][j0..j6 i16][px, py, pz i16][qx, qy, qz, qw i16][gripper i16][status u8]
+	EWireDecodeResult Decode(const uint8* Data, int32 Size)
+	{
+		FCompactReader R(Data, Size);
+		uint8 Flags = 0;
+
+		R.ReadHeader(Type, Flags, Sequence, Timestamp);
+		R.ReadUInt32(KeyframeSequence);
+		for (int i = 0; i < 7; ++i) R.ReadInt16(JointResiduals[i]);
+		for (int i = 0; i < 3; ++i) R.ReadInt16(PositionResiduals[i]);
+		for (int i = 0; i < 4; ++i) R.ReadInt16(QuatResiduals[i]);
+		R.ReadInt16(GripperResidual);
+		R.ReadUInt8(StatusFlags);
+
+		return R.GetResult();
+	}
+
+	/** Reconstruct the full state from the keyframe it references */
+	void ApplyTo(const FWireRobotState& Keyframe, FWireRobotState& Out) const
+	{
+		Out = Keyframe;
+		Out.Timestamp = Timestamp;
+		Out.Sequence = Sequence;
+		Out.Type = StateDelta::KeyframeType(Type);
+
+		for (int i = 0; i < 7; ++i) Out.JointPositions[i] += JointResiduals[i] * StateDelta::JointStep;
+		Out.EE_PX += PositionResiduals[0] * StateDelta::PositionStep;
+		Out.EE_PY += PositionResiduals[1] * StateDelta::PositionStep;
+		Out.EE_PZ += PositionResiduals[2] * StateDelta::PositionStep;
+		Out.EE_QX += QuatResiduals[0] * StateDelta::QuatStep;
+		Out.EE_QY += QuatResiduals[1] * StateDelta::QuatStep;
+		Out.EE_QZ += QuatResiduals[2] * StateDelta::QuatStep;
+		Out.EE_QW += QuatResiduals[3] * StateDelta::QuatStep;
+		Out.GripperWidth += GripperResidual * StateDelta::GripperStep;
+		Out.StatusFlags = StatusFlags;
+
+		// Quantization error leaves the quaternion slightly off unit length
+		const double Norm = FMath::Sqrt(Out.EE_QX * Out.EE_QX + Out.EE_QY * Out.EE_QY + Out.EE_QZ * Out.EE_QZ + Out.EE_QW * Out.EE_QW);
+		if (Norm > UE_SMALL_NUMBER)
+		{
+			Out.EE_QX /= Norm; Out.EE_QY /= Norm; Out.EE_QZ /= Norm; Out.EE_QW /= Norm;
+		}
 	}
 };
 
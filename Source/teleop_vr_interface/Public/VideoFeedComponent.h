@@ -51,7 +51,6 @@ private:
 
 	void CreateDisplayPlane();
 	void UpdatePlaneScale(int32 Width, int32 Height);
-	void EnsureTextureSize(int32 Width, int32 Height);
 
 	// Display
 	UPROPERTY()
@@ -60,15 +59,17 @@ private:
 	UPROPERTY()
 	TObjectPtr<UMaterialInstanceDynamic> DynamicMaterial;
 
+	// Frames are written straight into this target; sources resize it in place,
+	// so the material binding made in CreateDisplayPlane stays valid
 	UPROPERTY()
-	TObjectPtr<UTexture2D> VideoTexture;
+	TObjectPtr<UTextureRenderTarget2D> VideoTarget;
 
 	// Source management
 	TMap<FString, TUniquePtr<IVideoSource>> Sources;
 	FString ActiveSourceName;
 	IVideoSource* ActiveSource = nullptr;
 
-	// Texture state
+	// Resolution last seen from the active source
 	int32 CurrentTextureWidth = 0;
 	int32 CurrentTextureHeight = 0;
 
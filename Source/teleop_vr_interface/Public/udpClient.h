@@ -6,40 +6,157 @@
 #include "SocketSubsystem.h"
 #include "Networking.h"
 #include "HAL/PlatformTime.h"
+#include "Templates/Function.h"
+#include "ITransport.h"
+#include "PacketDemux.h"
 
+class FSessionRecordLane;
 
-class udpClient : public FRunnable
+// Batched datagram I/O (recvmmsg / sendmmsg) needs a native socket, which is only
+// wired up on Linux-based platforms. Everything else uses FSocket, one call per datagram.
+#ifndef UDPCLIENT_NATIVE_BATCHING
+#define UDPCLIENT_NATIVE_BATCHING (PLATFORM_LINUX || PLATFORM_ANDROID)
+#endif
+
+/**
+ * Optional socket settings. Traffic class and priority are only applied by the
+ * native socket path; the FSocket fallback logs a warning and ignores them.
+ */
+struct FUdpSocketOptions
+{
+	/** DSCP code point for every datagram sent, 0-63 (-1 = OS default). 46 = EF, 34 = AF41. */
+	int32 Dscp = -1;
+
+	/** Linux SO_PRIORITY, 0-6 (-1 = derived from Dscp by the kernel). Picks the egress queue of the qdisc / NIC. */
+	int32 SocketPriority = -1;
+
+	/** Multicast group to join for receiving, IPv4 or IPv6 (empty = none) */
+	FString MulticastGroup;
+
+	/** Interface name for joining the group and for multicast sends (empty = the routing table's choice) */
+	FString MulticastInterface;
+
+	/** Hop limit of multicast datagrams sent, when the remote address is a group */
+	int32 MulticastTtl = 1;
+
+	/** Deliver our own multicast datagrams back to listeners on this host */
+	bool bMulticastLoopback = true;
+
+	/**
+	 * Open a dual-stack IPv6 socket, so IPv6 and IPv4 (as v4-mapped) peers can be
+	 * mixed. Implied when the remote address or the multicast group is IPv6.
+	 */
+	bool bIPv6 = false;
+};
+
+
+class udpClient : public ITransport, public FRunnable
 {
 public:
 	udpClient();
-	udpClient(FString ip_address, bool send_enabled, int32 sPort, bool receive_enabled, int32 rPort);
+	udpClient(FString ip_address, bool send_enabled, int32 sPort, bool receive_enabled, int32 rPort,
+		const FUdpSocketOptions& InOptions = FUdpSocketOptions());
 	~udpClient();
 
-	void stop();
+	virtual void stop() override;
 
 	// --- Raw send (new protocol: caller handles serialization) ---
-	bool send_raw(const uint8* Data, int32 Size);
+	virtual bool send_raw(const uint8* Data, int32 Size) override;
 
-	// --- Raw receive ---
-	/** Returns true if new data arrived since last call to get_raw_data */
-	bool has_new_data() const { return bNewData; }
+	// --- Batched send: queue a frame's messages, then flush them in one syscall where supported ---
+	/** Copy a message into the outbound batch. Flushes automatically when the batch is full. */
+	virtual void queue_send(const uint8* Data, int32 Size) override;
 
-	/** Get raw received buffer. Caller is responsible for deserialization. Clears new-data flag. */
-	TArray<uint8> get_raw_data();
+	/** Send everything queued since the last flush. Returns false if any datagram failed. */
+	virtual bool flush_sends() override;
 
-	/** Connection health check */
-	bool isConnectionAlive() const;
+	/**
+	 * Send datagrams stored back to back in Data, one size per entry in Sizes.
+	 * Uses no shared batch state, so it may be called from any one thread in
+	 * parallel with the game thread's queue_send / flush_sends.
+	 */
+	virtual bool send_batch(const uint8* Data, const int32* Sizes, int32 Count) override;
+
+	/**
+	 * Send datagrams enveloped for Endpoint to this address; endpoints without one
+	 * share the primary address. Call before sending starts, the table is not locked.
+	 */
+	virtual void set_endpoint_address(uint8 Endpoint, const FString& Ip, int32 Port) override;
+
+	// --- Raw receive (demultiplexed by endpoint envelope and type byte) ---
+	/** Returns true if any packet arrived since the last call to drain */
+	virtual bool has_new_data() const override { return Demux.HasNewData(); }
+
+	/**
+	 * Visit every packet received since the last call. Queued types are visited in
+	 * arrival order, all other types deliver only their newest packet.
+	 * Caller is responsible for deserialization. Must be called from a single thread.
+	 */
+	virtual void drain(TFunctionRef<void(const FRawPacket&)> Visitor) override { Demux.Drain(Visitor); }
+
+	/**
+	 * Route every packet of this type through a bounded FIFO instead of the
+	 * latest-value mailbox, so none are overwritten. Call once per type.
+	 */
+	virtual void enable_queue(uint8 MsgType, int32 Capacity) override { Demux.EnableQueue(MsgType, Capacity); }
+
+	/**
+	 * Inspect every well-formed datagram on the receive thread, before it is handed
+	 * to the game thread. The observer must be fast and must not block. Call once.
+	 */
+	virtual void set_receive_observer(TFunction<void(uint8 Endpoint, uint8 MsgType, const uint8* Data, int32 Size, double ReceiveTime)> Observer) override
+	{
+		Demux.SetObserver(MoveTemp(Observer));
+	}
 
-	/** Last sender timestamp (if protocol includes it) */
-	int64_t get_sender_time();
+	/**
+	 * Capture every datagram received and every datagram handed to the socket for
+	 * sending. Takes one recorder lane per sending or receiving thread. The recorder
+	 * must outlive the socket. Call once.
+	 */
+	virtual void set_recorder(FSessionRecorder* Recorder) override;
+
+	/** Packets superseded before being read, rejected by a full queue, or without a readable type byte */
+	virtual uint32 get_dropped_count() const override { return Demux.GetDroppedCount(); }
+
+	/** Packets of one endpoint and type superseded in its mailbox or rejected by its full queue */
+	virtual uint32 get_dropped_count(uint8 Endpoint, uint8 MsgType) const override { return Demux.GetDroppedCount(Endpoint, MsgType); }
+
+	/** Connection health check */
+	virtual bool isConnectionAlive() const override;
 
 private:
 	// FRunnable
 	virtual uint32 Run() override;
 
+	/** Create, configure and bind the socket. Platform specific. */
+	bool open_socket();
+
+	/** Traffic class, priority and multicast settings from Options. Failures are logged, not fatal. */
+	void apply_socket_options();
+
 	ISocketSubsystem* SocketSubsystem = nullptr;
 	FSocket* Socket = nullptr;
+#if UDPCLIENT_NATIVE_BATCHING
+	int NativeSocket = -1;
+	bool bNativeIPv6 = false;
+
+	/** SO_TIMESTAMPNS is enabled: every datagram carries the time the kernel received it */
+	bool bKernelTimestamps = false;
+
+	/** Destination as a native sockaddr_in or sockaddr_in6, whichever the socket's family needs */
+	struct FNativeAddress
+	{
+		alignas(8) uint8 Storage[28] = {};
+		uint32 Length = 0;
+	};
+	FNativeAddress NativeRemotes[FPacketDemux::MaxEndpoints];	// per endpoint
+
+	/** Parse Ip for the socket's family; an IPv4 address becomes v4-mapped on an IPv6 socket */
+	bool resolve_native(const FString& Ip, int32 Port, FNativeAddress& Out) const;
+#endif
 	TSharedPtr<FInternetAddr> RemoteAddr;
+	TSharedPtr<FInternetAddr> EndpointAddrs[FPacketDemux::MaxEndpoints];	// null = RemoteAddr
 	TSharedPtr<FInternetAddr> LocalAddr;
 	FRunnableThread* ReceiverThread = nullptr;
 
@@ -49,13 +166,34 @@ private:
 	int32 sendPort = 0;
 	int32 receivePort = 0;
 	int32 BufferSize;
+	FUdpSocketOptions Options;
+
+	/** Upper bound on how long the receive thread blocks before re-checking bStop */
+	double RecvWaitTimeoutMs = 100.0;
+
+	/** Datagrams drained per recvmmsg call */
+	static constexpr int32 RecvBatchSize = 32;
+
+	// Outbound batch: payloads back to back, one size entry per datagram (game thread only)
+	static constexpr int32 MaxSendBatch = 16;
+	TArray<uint8> SendBatchData;
+	TArray<int32, TInlineAllocator<MaxSendBatch>> SendBatchSizes;
+
+	void dispatch_packet(const uint8* Data, int32 Size, double ReceiveTime);
+
+	/** Send on the platform socket, without the write-enabled check or recording */
+	bool transmit(const uint8* Data, int32 Size);
+	bool transmit_batch(const uint8* Data, const int32* Sizes, int32 Count);
+	void record_sent(FSessionRecordLane* Lane, const uint8* Data, const int32* Sizes, int32 Count);
+
+	// Session recording: one lane per thread (receive, game-thread sends, send_batch callers)
+	FSessionRecordLane* RecvRecordLane = nullptr;
+	FSessionRecordLane* SendRecordLane = nullptr;
+	FSessionRecordLane* BatchRecordLane = nullptr;
+	TAtomic<bool> bRecording{ false };
 
-	// Receive state
-	TArray<uint8> ReceiveBuffer;
-	TArray<uint8> LatestPacket;
-	FCriticalSection MsgLock;
-	TAtomic<bool> bNewData;
+	// Receive state: one mailbox per type byte, written only by the receive thread
+	FPacketDemux Demux;
 	TAtomic<bool> bStop{ false };
 	double last_recv_time = 0.0;
-	int64_t sender_time = 0;
 };
\ No newline at end of file
@@ -0,0 +1,1317 @@
+// ============================================================================
+// LoopbackSim: stand-in for the robot simulator, plus a load generator.
+//
+//   loopback_sim serve [--port 5010 | --shm name] [--loss %] [--reorder %] [--reorder-delay ms]
+//                      [--latency ms] [--jitter ms] [--status-rate Hz] [--state-rate Hz]
+//                      [--report s] [--seed n]
+//
+//     Answers an operator interface (UComLink) the way the simulator would:
+//       hand pose  -> robot state of that arm (end effector = the pose, gripper = trigger)
+//       head pose  -> pan-tilt state (yaw / pitch of the head orientation)
+//       ping       -> pong, so clock sync and corrected latency work
+//       mode command / config update -> command ack
+//     and sends system status at --status-rate. Every echo keeps the sequence
+//     number of the message it answers, so loss and reordering show up in the
+//     operator's stream statistics. With --state-rate, robot states are instead
+//     published on their own schedule like the real simulator: each arm's latest
+//     state is re-sent at that rate with its own sequence numbers, whatever the
+//     operator's pose rate (load matches round trips only in the default 1:1 mode).
+//     Replies go to the sender's address, in the
+//     sender's encoding (msgpack or compact) and to the sender's endpoint, so one
+//     serve instance stands in for every robot behind a UComLink. Loss,
+//     reordering, latency and jitter are applied to everything sent.
+//
+//     With --shm the simulator side of the shared-memory transport is used
+//     instead of UDP (UComLink RemoteIP "shm://name"), see SharedMemoryTransport.h.
+//
+//   loopback_sim load [--target 127.0.0.1:5010 | --shm name] [--arms 8] [--rate 1000]
+//                     [--duration 10] [--compact] [--endpoints] [--report s]
+//
+//     Stands in for the operator: drives --arms hand-pose streams at --rate Hz
+//     each (two arms per socket) against a serve instance and reports echo
+//     round-trip time, loss and reordering. A shared-memory link carries a
+//     single operator, so --shm drives at most two arms. With --endpoints every
+//     arm pair is a robot endpoint on one socket or segment instead, like a
+//     multi-robot UComLink (at most 16 arms).
+//
+// The wire format mirrors Source/teleop_vr_interface/Public/TeleOpTypes.h and
+// the shared segment layout SharedMemoryTransport.h; both depend on Unreal and
+// cannot be included here. Linux only (ppoll, futex).
+// ============================================================================
+
+#include <msgpack.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <climits>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ============================================================================
+// Protocol (see TeleOpTypes.h)
+// ============================================================================
+
+namespace MsgType
+{
+	constexpr uint8_t HeadPose = 0x01;
+	constexpr uint8_t HandLeft = 0x02;
+	constexpr uint8_t HandRight = 0x03;
+	constexpr uint8_t ModeCommand = 0x04;
+	constexpr uint8_t StateAck = 0x05;
+	constexpr uint8_t RobotStateRight = 0x10;
+	constexpr uint8_t RobotStateLeft = 0x11;
+	constexpr uint8_t PanTiltState = 0x12;
+	constexpr uint8_t SystemStatus = 0x13;
+	constexpr uint8_t ConfigUpdate = 0x20;
+	constexpr uint8_t TimeSyncPing = 0x21;
+	constexpr uint8_t TimeSyncPong = 0x22;
+	constexpr uint8_t CommandAck = 0x23;
+}
+
+namespace Compact
+{
+	constexpr uint8_t Magic = 0xC1;
+	constexpr uint8_t FlagSmallestThree = 0x01;
+	constexpr size_t HeaderSize = 3 + 4 + 8;
+	constexpr double SmallestThreeRange = 0.70710678118654752;
+}
+
+/** [tag][endpoint] in front of a message for any endpoint but 0 */
+namespace Endpoint
+{
+	constexpr uint8_t Tag = 0xC2;
+	constexpr size_t HeaderSize = 2;
+	constexpr int MaxEndpoints = 8;
+
+	/** Strip the envelope, if any. False if it is truncated or names an endpoint out of range. */
+	static bool Split(const uint8_t*& Data, size_t& Size, uint8_t& Out)
+	{
+		Out = 0;
+		if (Size == 0 || Data[0] != Tag) return true;
+		if (Size < HeaderSize || Data[1] >= MaxEndpoints) return false;
+		Out = Data[1];
+		Data += HeaderSize;
+		Size -= HeaderSize;
+		return true;
+	}
+
+	static std::vector<uint8_t> Wrap(uint8_t Id, std::vector<uint8_t> Bytes)
+	{
+		if (Id != 0)
+		{
+			const uint8_t Header[HeaderSize] = { Tag, Id };
+			Bytes.insert(Bytes.begin(), Header, Header + HeaderSize);
+		}
+		return Bytes;
+	}
+}
+
+static double NowSeconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t NowNs()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/** Type, sequence and timestamp common to every message */
+struct FHeader
+{
+	uint64_t Timestamp = 0;
+	uint32_t Sequence = 0;
+	uint8_t Type = 0;
+	uint8_t Flags = 0;
+	bool bCompact = false;
+};
+
+struct FPose
+{
+	FHeader Header;
+	double P[3] = {};
+	double Q[4] = { 0, 0, 0, 1 };
+	double Trigger = 0.0;
+};
+
+// --- Decoding ---
+
+class FCompactReader
+{
+public:
+	FCompactReader(const uint8_t* InData, size_t InSize) : Data(InData), Size(InSize), Pos(0) {}
+
+	bool Ok() const { return bOk; }
+
+	uint64_t ReadLE(size_t Bytes)
+	{
+		if (!bOk || Pos + Bytes > Size) { bOk = false; return 0; }
+		uint64_t Value = 0;
+		for (size_t i = 0; i < Bytes; ++i) Value |= static_cast<uint64_t>(Data[Pos++]) << (8 * i);
+		return Value;
+	}
+
+	double ReadFloat()
+	{
+		const uint32_t Bits = static_cast<uint32_t>(ReadLE(4));
+		float F;
+		std::memcpy(&F, &Bits, sizeof(F));
+		return F;
+	}
+
+	void ReadHeader(FHeader& Out)
+	{
+		ReadLE(1);	// magic
+		Out.Type = static_cast<uint8_t>(ReadLE(1));
+		Out.Flags = static_cast<uint8_t>(ReadLE(1));
+		Out.Sequence = static_cast<uint32_t>(ReadLE(4));
+		Out.Timestamp = ReadLE(8);
+		Out.bCompact = true;
+	}
+
+	void ReadQuat(uint8_t Flags, double Q[4])
+	{
+		if (!(Flags & Compact::FlagSmallestThree))
+		{
+			for (int i = 0; i < 4; ++i) Q[i] = ReadFloat();
+			return;
+		}
+
+		const uint32_t Packed = static_cast<uint32_t>(ReadLE(4));
+		const int Largest = static_cast<int>(Packed >> 30);
+		double SumSquares = 0.0;
+		int Shift = 20;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (i == Largest) continue;
+			Q[i] = (static_cast<double>((Packed >> Shift) & 0x3FF) / 1023.0 * 2.0 - 1.0) * Compact::SmallestThreeRange;
+			SumSquares += Q[i] * Q[i];
+			Shift -= 10;
+		}
+		Q[Largest] = std::sqrt(std::max(0.0, 1.0 - SumSquares));
+	}
+
+private:
+	const uint8_t* Data;
+	size_t Size;
+	size_t Pos;
+	bool bOk = true;
+};
+
+/** Decode a msgpack message into its top-level array. Throws on malformed input. */
+static msgpack::object_handle UnpackArray(const uint8_t* Data, size_t Size, uint32_t MinCount)
+{
+	msgpack::object_handle Handle = msgpack::unpack(reinterpret_cast<const char*>(Data), Size);
+	const msgpack::object& Obj = Handle.get();
+	if (Obj.type != msgpack::type::ARRAY || Obj.via.array.size < MinCount)
+	{
+		throw msgpack::type_error();
+	}
+	return Handle;
+}
+
+static bool DecodeHeader(const uint8_t* Data, size_t Size, FHeader& Out)
+{
+	if (Size > 0 && Data[0] == Compact::Magic)
+	{
+		FCompactReader R(Data, Size);
+		R.ReadHeader(Out);
+		return R.Ok();
+	}
+
+	try
+	{
+		msgpack::object_handle Handle = UnpackArray(Data, Size, 3);
+		const msgpack::object* Items = Handle.get().via.array.ptr;
+		Out.Timestamp = Items[0].as<uint64_t>();
+		Out.Sequence = Items[1].as<uint32_t>();
+		Out.Type = Items[2].as<uint8_t>();
+		Out.bCompact = false;
+		return true;
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+}
+
+static bool DecodePose(const uint8_t* Data, size_t Size, FPose& Out)
+{
+	if (Size > 0 && Data[0] == Compact::Magic)
+	{
+		FCompactReader R(Data, Size);
+		R.ReadHeader(Out.Header);
+		for (double& P : Out.P) P = R.ReadFloat();
+		R.ReadQuat(Out.Header.Flags, Out.Q);
+		if (Out.Header.Type != MsgType::HeadPose) Out.Trigger = R.ReadFloat();
+		return R.Ok();
+	}
+
+	try
+	{
+		msgpack::object_handle Handle = UnpackArray(Data, Size, 10);
+		const msgpack::object& Obj = Handle.get();
+		const msgpack::object* Items = Obj.via.array.ptr;
+		Out.Header.Timestamp = Items[0].as<uint64_t>();
+		Out.Header.Sequence = Items[1].as<uint32_t>();
+		Out.Header.Type = Items[2].as<uint8_t>();
+		for (int i = 0; i < 3; ++i) Out.P[i] = Items[3 + i].as<double>();
+		for (int i = 0; i < 4; ++i) Out.Q[i] = Items[6 + i].as<double>();
+		Out.Trigger = Obj.via.array.size > 10 ? Items[10].as<double>() : 0.0;
+		return true;
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+}
+
+// --- Encoding ---
+
+/** One outbound message in either encoding */
+class FMessageWriter
+{
+public:
+	FMessageWriter(bool bInCompact, uint8_t Type, uint32_t Sequence, uint64_t Timestamp, uint32_t NumFields)
+		: bCompact(bInCompact), Packer(&Buffer)
+	{
+		if (bCompact)
+		{
+			PutLE(Compact::Magic, 1);
+			PutLE(Type, 1);
+			PutLE(0, 1);
+			PutLE(Sequence, 4);
+			PutLE(Timestamp, 8);
+		}
+		else
+		{
+			Packer.pack_array(3 + NumFields);
+			Packer.pack(Timestamp);
+			Packer.pack(Sequence);
+			Packer.pack(Type);
+		}
+	}
+
+	void UInt8(uint8_t Value) { if (bCompact) PutLE(Value, 1); else Packer.pack(Value); }
+	void UInt32(uint32_t Value) { if (bCompact) PutLE(Value, 4); else Packer.pack(Value); }
+	void UInt64(uint64_t Value) { if (bCompact) PutLE(Value, 8); else Packer.pack(Value); }
+
+	void Real(double Value)
+	{
+		if (bCompact)
+		{
+			const float F = static_cast<float>(Value);
+			uint32_t Bits;
+			std::memcpy(&Bits, &F, sizeof(Bits));
+			PutLE(Bits, 4);
+		}
+		else
+		{
+			Packer.pack(Value);
+		}
+	}
+
+	std::vector<uint8_t> Finish() const
+	{
+		return std::vector<uint8_t>(reinterpret_cast<const uint8_t*>(Buffer.data()),
+			reinterpret_cast<const uint8_t*>(Buffer.data()) + Buffer.size());
+	}
+
+private:
+	void PutLE(uint64_t Value, int Bytes)
+	{
+		char Tmp[8];
+		for (int i = 0; i < Bytes; ++i) Tmp[i] = static_cast<char>((Value >> (8 * i)) & 0xFF);
+		Buffer.write(Tmp, Bytes);
+	}
+
+	bool bCompact;
+	msgpack::sbuffer Buffer;
+	msgpack::packer<msgpack::sbuffer> Packer;
+};
+
+// [ts, seq, type, j0..j6, px, py, pz, qx, qy, qz, qw, gripper, status]
+static std::vector<uint8_t> EncodeRobotState(const FPose& Pose, bool bCompact)
+{
+	const uint8_t Type = Pose.Header.Type == MsgType::HandLeft ? MsgType::RobotStateLeft : MsgType::RobotStateRight;
+	FMessageWriter W(bCompact, Type, Pose.Header.Sequence, NowNs(), 16);
+
+	// Stand-in joint angles that move with the target
+	for (int i = 0; i < 7; ++i) W.Real(0.3 * std::sin(Pose.P[i % 3] + i));
+	for (double P : Pose.P) W.Real(P);
+	for (double Q : Pose.Q) W.Real(Q);
+	W.Real(0.08 * (1.0 - Pose.Trigger));
+	W.UInt8(0);
+	return W.Finish();
+}
+
+// [ts, seq, type, pan, tilt]
+static std::vector<uint8_t> EncodePanTilt(const FPose& Head, bool bCompact)
+{
+	const double X = Head.Q[0], Y = Head.Q[1], Z = Head.Q[2], W = Head.Q[3];
+	const double Pan = std::atan2(2.0 * (W * Z + X * Y), 1.0 - 2.0 * (Y * Y + Z * Z));
+	const double Tilt = std::asin(std::max(-1.0, std::min(1.0, 2.0 * (W * Y - Z * X))));
+
+	FMessageWriter Writer(bCompact, MsgType::PanTiltState, Head.Header.Sequence, NowNs(), 2);
+	Writer.Real(Pan);
+	Writer.Real(Tilt);
+	return Writer.Finish();
+}
+
+// [ts, seq, type, sim_state, sim_fps, error_code]
+static std::vector<uint8_t> EncodeSystemStatus(uint32_t Sequence, double SimFps, bool bCompact)
+{
+	FMessageWriter W(bCompact, MsgType::SystemStatus, Sequence, NowNs(), 3);
+	W.UInt8(2);		// Engaged
+	W.Real(SimFps);
+	W.UInt8(0);
+	return W.Finish();
+}
+
+// [ts = t2, seq, type, origin_ts = t0, receive_ts = t1]
+static std::vector<uint8_t> EncodePong(const FHeader& Ping, uint64_t ReceiveNs, uint32_t Sequence)
+{
+	FMessageWriter W(Ping.bCompact, MsgType::TimeSyncPong, Sequence, NowNs(), 2);
+	W.UInt64(Ping.Timestamp);
+	W.UInt64(ReceiveNs);
+	return W.Finish();
+}
+
+// [ts, seq, type, acked_type, acked_seq]
+static std::vector<uint8_t> EncodeCommandAck(const FHeader& Command, uint32_t Sequence)
+{
+	FMessageWriter W(Command.bCompact, MsgType::CommandAck, Sequence, NowNs(), 2);
+	W.UInt8(Command.Type);
+	W.UInt32(Command.Sequence);
+	return W.Finish();
+}
+
+// [ts, seq, type, px, py, pz, qx, qy, qz, qw, trigger]
+static std::vector<uint8_t> EncodeHandPose(uint8_t Type, uint32_t Sequence, double Phase, bool bCompact)
+{
+	FMessageWriter W(bCompact, Type, Sequence, NowNs(), 8);
+	W.Real(0.5 + 0.1 * std::cos(Phase));
+	W.Real(Type == MsgType::HandLeft ? 0.2 : -0.2);
+	W.Real(0.3 + 0.1 * std::sin(Phase));
+	W.Real(0.0); W.Real(0.0); W.Real(std::sin(Phase * 0.5)); W.Real(std::cos(Phase * 0.5));
+	W.Real(0.5 + 0.5 * std::sin(Phase * 0.25));
+	return W.Finish();
+}
+
+// ============================================================================
+// Links: UDP sockets, or the simulator / operator side of a shared segment
+// ============================================================================
+
+/** Datagram link to the peer. A link may have several channels (one per socket). */
+class FLink
+{
+public:
+	virtual ~FLink() = default;
+
+	/** Send one datagram on a channel. UDP sends to To, or to the link's remote when null. */
+	virtual void Send(int Channel, const uint8_t* Data, size_t Size, const sockaddr_in* To) = 0;
+
+	/** Next waiting datagram on any channel, false if there is none */
+	virtual bool Receive(std::vector<uint8_t>& Buffer, size_t& Size, int& Channel, sockaddr_in& From) = 0;
+
+	/** Wait until a datagram may be readable or Deadline passes */
+	virtual void Wait(double Deadline) = 0;
+
+	int NumChannels() const { return Channels; }
+
+protected:
+	int Channels = 1;
+};
+
+class FUdpLink : public FLink
+{
+public:
+	FUdpLink(uint16_t BindPort, int NumSockets, const sockaddr_in* InRemote)
+	{
+		Channels = NumSockets;
+		if (InRemote) Remote = *InRemote;
+		for (int i = 0; i < NumSockets; ++i)
+		{
+			Fds.push_back(pollfd{ OpenSocket(BindPort), POLLIN, 0 });
+		}
+	}
+
+	~FUdpLink() override
+	{
+		for (const pollfd& Fd : Fds) close(Fd.fd);
+	}
+
+	void Send(int Channel, const uint8_t* Data, size_t Size, const sockaddr_in* To) override
+	{
+		const sockaddr_in& Address = To ? *To : Remote;
+		sendto(Fds[Channel].fd, Data, Size, 0, reinterpret_cast<const sockaddr*>(&Address), sizeof(Address));
+	}
+
+	bool Receive(std::vector<uint8_t>& Buffer, size_t& Size, int& Channel, sockaddr_in& From) override
+	{
+		for (int i = 0; i < Channels; ++i)
+		{
+			const int Candidate = (NextChannel + i) % Channels;
+			socklen_t FromLen = sizeof(From);
+			const ssize_t Received = recvfrom(Fds[Candidate].fd, Buffer.data(), Buffer.size(), MSG_DONTWAIT,
+				reinterpret_cast<sockaddr*>(&From), &FromLen);
+			if (Received > 0)
+			{
+				Size = static_cast<size_t>(Received);
+				Channel = Candidate;
+				NextChannel = (Candidate + 1) % Channels;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Wait(double Deadline) override
+	{
+		const double Remaining = std::max(0.0, Deadline - NowSeconds());
+		timespec Timeout;
+		Timeout.tv_sec = static_cast<time_t>(Remaining);
+		Timeout.tv_nsec = static_cast<long>((Remaining - static_cast<double>(Timeout.tv_sec)) * 1e9);
+		for (pollfd& Fd : Fds) Fd.revents = 0;
+		ppoll(Fds.data(), Fds.size(), &Timeout, nullptr);
+	}
+
+private:
+	static int OpenSocket(uint16_t BindPort)
+	{
+		const int Socket = socket(AF_INET, SOCK_DGRAM, 0);
+		if (Socket < 0)
+		{
+			std::perror("socket");
+			std::exit(1);
+		}
+
+		const int BufferBytes = 4 * 1024 * 1024;
+		setsockopt(Socket, SOL_SOCKET, SO_RCVBUF, &BufferBytes, sizeof(BufferBytes));
+		setsockopt(Socket, SOL_SOCKET, SO_SNDBUF, &BufferBytes, sizeof(BufferBytes));
+
+		sockaddr_in Local = {};
+		Local.sin_family = AF_INET;
+		Local.sin_addr.s_addr = htonl(INADDR_ANY);
+		Local.sin_port = htons(BindPort);
+		if (bind(Socket, reinterpret_cast<sockaddr*>(&Local), sizeof(Local)) != 0)
+		{
+			std::perror("bind");
+			std::exit(1);
+		}
+		return Socket;
+	}
+
+	std::vector<pollfd> Fds;
+	sockaddr_in Remote = {};
+	int NextChannel = 0;
+};
+
+// Mirrors the segment layout in SharedMemoryTransport.h
+namespace Shm
+{
+	constexpr uint32_t Magic = 0x4D484554;
+	constexpr uint32_t Version = 1;
+	constexpr uint32_t WrapMarker = 0xFFFFFFFFu;
+	constexpr uint32_t RecordHeaderBytes = 8;
+	constexpr uint32_t MaxDatagramBytes = 4096;
+	constexpr uint32_t MinRingBytes = 64 * 1024;
+	constexpr int ToSimulator = 0;
+	constexpr int ToOperator = 1;
+
+	struct FSegmentHeader
+	{
+		std::atomic<uint32_t> Magic;
+		uint32_t Version;
+		uint32_t RingBytes;
+		uint32_t MaxDatagramBytes;
+		uint8_t Reserved[48];
+	};
+
+	struct FRingControl
+	{
+		alignas(64) std::atomic<int64_t> Head;
+		alignas(64) std::atomic<int64_t> Tail;
+		alignas(64) std::atomic<int32_t> Signal;
+		std::atomic<int32_t> Waiters;
+	};
+
+	static_assert(sizeof(FSegmentHeader) == 64 && sizeof(FRingControl) == 192, "Segment layout differs from SharedMemoryTransport.h");
+	constexpr size_t ControlAreaBytes = sizeof(FSegmentHeader) + 2 * sizeof(FRingControl);
+
+	inline uint32_t AlignUp(uint32_t Size) { return (Size + 7) & ~7u; }
+}
+
+class FShmLink : public FLink
+{
+public:
+	FShmLink(const std::string& Name, bool bSimulatorSide, uint32_t RequestedRingBytes)
+	{
+		const std::string Path = "/" + Name;
+		int Fd = shm_open(Path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		const bool bCreated = Fd >= 0;
+		if (!bCreated && errno == EEXIST) Fd = shm_open(Path.c_str(), O_RDWR, 0);
+		if (Fd < 0)
+		{
+			std::perror("shm_open");
+			std::exit(1);
+		}
+
+		if (bCreated)
+		{
+			RingBytes = Shm::MinRingBytes;
+			while (RingBytes < RequestedRingBytes) RingBytes <<= 1;
+			if (ftruncate(Fd, static_cast<off_t>(SegmentBytes())) != 0)
+			{
+				std::perror("ftruncate");
+				shm_unlink(Path.c_str());
+				std::exit(1);
+			}
+		}
+		else
+		{
+			// Wait for the creator to publish the header
+			const double Deadline = NowSeconds() + 2.0;
+			for (;;)
+			{
+				struct stat Info;
+				if (fstat(Fd, &Info) == 0 && static_cast<size_t>(Info.st_size) >= Shm::ControlAreaBytes)
+				{
+					void* Mapped = mmap(nullptr, sizeof(Shm::FSegmentHeader), PROT_READ, MAP_SHARED, Fd, 0);
+					const Shm::FSegmentHeader* Header = static_cast<const Shm::FSegmentHeader*>(Mapped);
+					const bool bReady = Header->Magic.load() == Shm::Magic;
+					const uint32_t FoundVersion = Header->Version;
+					RingBytes = Header->RingBytes;
+					munmap(Mapped, sizeof(Shm::FSegmentHeader));
+
+					if (bReady && (FoundVersion != Shm::Version || RingBytes < Shm::MinRingBytes || (RingBytes & (RingBytes - 1))))
+					{
+						std::fprintf(stderr, "/dev/shm/%s is not a version %u segment; delete it to start over\n", Name.c_str(), Shm::Version);
+						std::exit(1);
+					}
+					if (bReady && static_cast<size_t>(Info.st_size) >= SegmentBytes()) break;
+				}
+				if (NowSeconds() > Deadline)
+				{
+					std::fprintf(stderr, "/dev/shm/%s was never initialized; delete it to start over\n", Name.c_str());
+					std::exit(1);
+				}
+				usleep(1000);
+			}
+		}
+
+		void* Mapped = mmap(nullptr, SegmentBytes(), PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+		close(Fd);
+		if (Mapped == MAP_FAILED)
+		{
+			std::perror("mmap");
+			std::exit(1);
+		}
+		Segment = static_cast<uint8_t*>(Mapped);
+
+		Shm::FRingControl* Controls = reinterpret_cast<Shm::FRingControl*>(Segment + sizeof(Shm::FSegmentHeader));
+		const int TxRing = bSimulatorSide ? Shm::ToOperator : Shm::ToSimulator;
+		const int RxRing = bSimulatorSide ? Shm::ToSimulator : Shm::ToOperator;
+		Tx = &Controls[TxRing];
+		Rx = &Controls[RxRing];
+		TxData = Segment + Shm::ControlAreaBytes + static_cast<size_t>(TxRing) * RingBytes;
+		RxData = Segment + Shm::ControlAreaBytes + static_cast<size_t>(RxRing) * RingBytes;
+
+		if (bCreated)
+		{
+			Shm::FSegmentHeader* Header = reinterpret_cast<Shm::FSegmentHeader*>(Segment);
+			Header->Version = Shm::Version;
+			Header->RingBytes = RingBytes;
+			Header->MaxDatagramBytes = Shm::MaxDatagramBytes;
+			Header->Magic.store(Shm::Magic);
+		}
+		std::printf("shared memory /dev/shm/%s: %u KB per direction (%s)\n", Name.c_str(), RingBytes / 1024, bCreated ? "created" : "attached");
+	}
+
+	~FShmLink() override
+	{
+		munmap(Segment, SegmentBytes());
+	}
+
+	void Send(int, const uint8_t* Data, size_t Size, const sockaddr_in*) override
+	{
+		if (Size == 0 || Size > Shm::MaxDatagramBytes) return;
+
+		int64_t Head = Tx->Head.load(std::memory_order_relaxed);
+		const uint32_t Needed = Shm::RecordHeaderBytes + Shm::AlignUp(static_cast<uint32_t>(Size));
+		const uint64_t Offset = static_cast<uint64_t>(Head) & (RingBytes - 1);
+		const uint32_t Padding = RingBytes - Offset < Needed ? static_cast<uint32_t>(RingBytes - Offset) : 0;
+		if (Head + Padding + Needed - Tx->Tail.load() > RingBytes)
+		{
+			++Overflows;
+			return;
+		}
+
+		if (Padding > 0)
+		{
+			std::memcpy(TxData + Offset, &Shm::WrapMarker, sizeof(uint32_t));
+			Head += Padding;
+		}
+		uint8_t* Slot = TxData + (static_cast<uint64_t>(Head) & (RingBytes - 1));
+		const uint32_t Size32 = static_cast<uint32_t>(Size);
+		std::memcpy(Slot, &Size32, sizeof(Size32));
+		std::memcpy(Slot + Shm::RecordHeaderBytes, Data, Size);
+		Tx->Head.store(Head + Needed);
+
+		Tx->Signal.fetch_add(1);
+		if (Tx->Waiters.load() > 0)
+		{
+			syscall(SYS_futex, reinterpret_cast<int*>(&Tx->Signal), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+		}
+	}
+
+	bool Receive(std::vector<uint8_t>& Buffer, size_t& Size, int& Channel, sockaddr_in& From) override
+	{
+		int64_t Tail = Rx->Tail.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			if (Tail == Rx->Head.load()) return false;
+
+			const uint64_t Offset = static_cast<uint64_t>(Tail) & (RingBytes - 1);
+			uint32_t Length;
+			std::memcpy(&Length, RxData + Offset, sizeof(Length));
+			if (Length == Shm::WrapMarker)
+			{
+				Tail += RingBytes - Offset;
+				Rx->Tail.store(Tail);
+				continue;
+			}
+
+			Size = std::min<size_t>(Length, Buffer.size());
+			std::memcpy(Buffer.data(), RxData + Offset + Shm::RecordHeaderBytes, Size);
+			Rx->Tail.store(Tail + Shm::RecordHeaderBytes + Shm::AlignUp(Length));
+			Channel = 0;
+			From = {};
+			return true;
+		}
+	}
+
+	void Wait(double Deadline) override
+	{
+		// Poll briefly first, like the operator side, then sleep on the futex.
+		// On a single core spinning only delays the peer.
+		const double SpinEnd = std::min(Deadline, NowSeconds() + SpinSeconds);
+		while (NowSeconds() < SpinEnd)
+		{
+			if (Rx->Head.load() != Rx->Tail.load(std::memory_order_relaxed)) return;
+		}
+
+		const double Remaining = std::min(0.1, Deadline - NowSeconds());
+		if (Remaining <= 0.0) return;
+
+		const int32_t Seen = Rx->Signal.load();
+		Rx->Waiters.fetch_add(1);
+		if (Rx->Head.load() == Rx->Tail.load(std::memory_order_relaxed))
+		{
+			timespec Timeout;
+			Timeout.tv_sec = static_cast<time_t>(Remaining);
+			Timeout.tv_nsec = static_cast<long>((Remaining - static_cast<double>(Timeout.tv_sec)) * 1e9);
+			syscall(SYS_futex, reinterpret_cast<int*>(&Rx->Signal), FUTEX_WAIT, Seen, &Timeout, nullptr, 0);
+		}
+		Rx->Waiters.fetch_sub(1);
+	}
+
+	uint64_t Overflows = 0;
+
+private:
+	size_t SegmentBytes() const { return Shm::ControlAreaBytes + 2 * static_cast<size_t>(RingBytes); }
+
+	const double SpinSeconds = std::thread::hardware_concurrency() > 1 ? 50e-6 : 0.0;
+	uint8_t* Segment = nullptr;
+	uint32_t RingBytes = 0;
+	Shm::FRingControl* Tx = nullptr;
+	Shm::FRingControl* Rx = nullptr;
+	uint8_t* TxData = nullptr;
+	uint8_t* RxData = nullptr;
+};
+
+// ============================================================================
+// Network impairment: loss, latency, jitter and reordering on the send path
+// ============================================================================
+
+struct FImpairment
+{
+	double LossPercent = 0.0;
+	double ReorderPercent = 0.0;
+	double ReorderDelayMs = 2.0;
+	double LatencyMs = 0.0;
+	double JitterMs = 0.0;		// standard deviation
+};
+
+class FImpairedSender
+{
+public:
+	FImpairedSender(FLink& InLink, const FImpairment& InConfig, uint32_t Seed)
+		: Link(InLink), Config(InConfig), Rng(Seed) {}
+
+	/** Drop, delay or hold back one datagram according to the impairment settings */
+	void Send(std::vector<uint8_t> Bytes, const sockaddr_in& To)
+	{
+		if (Chance(Config.LossPercent))
+		{
+			++Lost;
+			return;
+		}
+
+		double DelayMs = Config.LatencyMs;
+		if (Config.JitterMs > 0.0)
+		{
+			DelayMs += std::normal_distribution<double>(0.0, Config.JitterMs)(Rng);
+		}
+		if (Chance(Config.ReorderPercent))
+		{
+			DelayMs += Config.ReorderDelayMs;
+			++HeldBack;
+		}
+
+		if (DelayMs <= 0.0)
+		{
+			Transmit(Bytes, To);
+			return;
+		}
+		Pending.push(FPending{ NowSeconds() + DelayMs * 1e-3, NextOrder++, std::move(Bytes), To });
+	}
+
+	/** Send every delayed datagram that is due */
+	void Flush(double Now)
+	{
+		while (!Pending.empty() && Pending.top().Due <= Now)
+		{
+			Transmit(Pending.top().Bytes, Pending.top().To);
+			Pending.pop();
+		}
+	}
+
+	/** Time of the next delayed datagram, or a large value if none */
+	double NextDue() const { return Pending.empty() ? 1e300 : Pending.top().Due; }
+
+	uint64_t Sent = 0;
+	uint64_t Lost = 0;
+	uint64_t HeldBack = 0;
+
+private:
+	struct FPending
+	{
+		double Due;
+		uint64_t Order;		// keeps equal due times in submission order
+		std::vector<uint8_t> Bytes;
+		sockaddr_in To;
+
+		bool operator>(const FPending& Other) const
+		{
+			return Due != Other.Due ? Due > Other.Due : Order > Other.Order;
+		}
+	};
+
+	bool Chance(double Percent)
+	{
+		return Percent > 0.0 && std::uniform_real_distribution<double>(0.0, 100.0)(Rng) < Percent;
+	}
+
+	void Transmit(const std::vector<uint8_t>& Bytes, const sockaddr_in& To)
+	{
+		Link.Send(0, Bytes.data(), Bytes.size(), &To);
+		++Sent;
+	}
+
+	FLink& Link;
+	FImpairment Config;
+	std::mt19937 Rng;
+	std::priority_queue<FPending, std::vector<FPending>, std::greater<FPending>> Pending;
+	uint64_t NextOrder = 0;
+};
+
+// ============================================================================
+// Latency histogram: 10 us buckets up to 1 s
+// ============================================================================
+
+class FLatencyHistogram
+{
+public:
+	FLatencyHistogram() : Buckets(NumBuckets + 1, 0) {}
+
+	void Add(double Seconds)
+	{
+		const size_t Bucket = std::min(static_cast<size_t>(std::max(Seconds, 0.0) / BucketSeconds), NumBuckets);
+		++Buckets[Bucket];
+		++Count;
+		Sum += Seconds;
+		Max = std::max(Max, Seconds);
+		Min = Count == 1 ? Seconds : std::min(Min, Seconds);
+	}
+
+	/** Upper edge of the bucket holding the given fraction of samples, in ms */
+	double PercentileMs(double Fraction) const
+	{
+		if (Count == 0) return 0.0;
+		const uint64_t Target = static_cast<uint64_t>(std::ceil(Fraction * static_cast<double>(Count)));
+		uint64_t Seen = 0;
+		for (size_t i = 0; i <= NumBuckets; ++i)
+		{
+			Seen += Buckets[i];
+			if (Seen >= Target) return i == NumBuckets ? Max * 1e3 : (i + 1) * BucketSeconds * 1e3;
+		}
+		return Max * 1e3;
+	}
+
+	void Reset()
+	{
+		std::fill(Buckets.begin(), Buckets.end(), 0);
+		Count = 0;
+		Sum = Min = Max = 0.0;
+	}
+
+	uint64_t Count = 0;
+	double Sum = 0.0;
+	double Min = 0.0;
+	double Max = 0.0;
+
+private:
+	static constexpr double BucketSeconds = 10e-6;
+	static constexpr size_t NumBuckets = 100000;
+	std::vector<uint64_t> Buckets;
+};
+
+// ============================================================================
+// Shared helpers
+// ============================================================================
+
+static volatile sig_atomic_t bInterrupted = 0;
+
+static void OnSignal(int)
+{
+	bInterrupted = 1;
+}
+
+struct FOptions
+{
+	std::vector<std::string> Args;
+
+	bool Has(const char* Name) const
+	{
+		return std::find(Args.begin(), Args.end(), Name) != Args.end();
+	}
+
+	double Number(const char* Name, double Default) const
+	{
+		auto It = std::find(Args.begin(), Args.end(), Name);
+		return (It != Args.end() && It + 1 != Args.end()) ? std::atof((It + 1)->c_str()) : Default;
+	}
+
+	std::string Text(const char* Name, const char* Default) const
+	{
+		auto It = std::find(Args.begin(), Args.end(), Name);
+		return (It != Args.end() && It + 1 != Args.end()) ? *(It + 1) : std::string(Default);
+	}
+};
+
+// ============================================================================
+// serve: simulator stand-in
+// ============================================================================
+
+static int RunServe(const FOptions& Options)
+{
+	const uint16_t Port = static_cast<uint16_t>(Options.Number("--port", 5010));
+	const double StatusRate = Options.Number("--status-rate", 10.0);
+	const double StateRate = Options.Number("--state-rate", 0.0);
+	const double ReportInterval = Options.Number("--report", 1.0);
+
+	FImpairment Impairment;
+	Impairment.LossPercent = Options.Number("--loss", 0.0);
+	Impairment.ReorderPercent = Options.Number("--reorder", 0.0);
+	Impairment.ReorderDelayMs = Options.Number("--reorder-delay", 2.0);
+	Impairment.LatencyMs = Options.Number("--latency", 0.0);
+	Impairment.JitterMs = Options.Number("--jitter", 0.0);
+
+	const std::string ShmName = Options.Text("--shm", "");
+	std::unique_ptr<FLink> Link;
+	if (ShmName.empty())
+	{
+		Link.reset(new FUdpLink(Port, 1, nullptr));
+	}
+	else
+	{
+		Link.reset(new FShmLink(ShmName, true, static_cast<uint32_t>(Options.Number("--ring-kb", 1024)) * 1024));
+	}
+	FImpairedSender Sender(*Link, Impairment, static_cast<uint32_t>(Options.Number("--seed", 1)));
+
+	std::printf("loopback_sim serve: %s%s (loss %.1f%%, reorder %.1f%% +%.1f ms, latency %.1f ms, jitter %.1f ms)\n",
+		ShmName.empty() ? "listening on :" : "shared memory ", ShmName.empty() ? std::to_string(Port).c_str() : ShmName.c_str(),
+		Impairment.LossPercent, Impairment.ReorderPercent, Impairment.ReorderDelayMs,
+		Impairment.LatencyMs, Impairment.JitterMs);
+
+	std::vector<uint8_t> Buffer(65536);
+
+	sockaddr_in Peer = {};
+	bool bHasPeer = false;
+	bool bPeerCompact = false;
+	uint32_t PeerEndpoints = 0;		// one bit per endpoint heard from
+	uint32_t PongSequence[Endpoint::MaxEndpoints] = {}, AckSequence[Endpoint::MaxEndpoints] = {}, StatusSequence[Endpoint::MaxEndpoints] = {};
+	uint64_t Poses = 0, Pings = 0, Commands = 0, Other = 0, Malformed = 0;
+	uint64_t LastPoses = 0;
+
+	// --state-rate: latest hand pose per endpoint and arm (0 = right, 1 = left), republished on a schedule
+	struct FArmState
+	{
+		FPose Pose;
+		sockaddr_in From = {};
+		bool bValid = false;
+		uint32_t Sequence = 0;
+	};
+	FArmState ArmStates[Endpoint::MaxEndpoints][2];
+
+	const double Start = NowSeconds();
+	double NextStatus = Start;
+	double NextState = Start;
+	double NextReport = Start + ReportInterval;
+
+	while (!bInterrupted)
+	{
+		const double StatusDue = (bHasPeer && StatusRate > 0.0) ? NextStatus : 1e300;
+		const double StateDue = (bHasPeer && StateRate > 0.0) ? NextState : 1e300;
+		Link->Wait(std::min({ Sender.NextDue(), StatusDue, StateDue, NextReport }));
+
+		sockaddr_in From = {};
+		size_t Size = 0;
+		int Channel = 0;
+		while (Link->Receive(Buffer, Size, Channel, From))
+		{
+			const uint64_t ReceiveNs = NowNs();
+			const uint8_t* Message = Buffer.data();
+			size_t MessageSize = Size;
+			uint8_t Id = 0;
+			FHeader Header;
+			if (!Endpoint::Split(Message, MessageSize, Id) || !DecodeHeader(Message, MessageSize, Header))
+			{
+				++Malformed;
+				continue;
+			}
+			Peer = From;
+			bHasPeer = true;
+			bPeerCompact = Header.bCompact;
+			PeerEndpoints |= 1u << Id;
+
+			switch (Header.Type)
+			{
+			case MsgType::HandLeft:
+			case MsgType::HandRight:
+			case MsgType::HeadPose:
+			{
+				FPose Pose;
+				if (!DecodePose(Message, MessageSize, Pose))
+				{
+					++Malformed;
+					break;
+				}
+				++Poses;
+				if (Header.Type != MsgType::HeadPose && StateRate > 0.0)
+				{
+					FArmState& Arm = ArmStates[Id][Header.Type == MsgType::HandLeft ? 1 : 0];
+					Arm.Pose = Pose;
+					Arm.From = From;
+					Arm.bValid = true;
+					break;
+				}
+				Sender.Send(Endpoint::Wrap(Id, Header.Type == MsgType::HeadPose ? EncodePanTilt(Pose, Header.bCompact)
+					: EncodeRobotState(Pose, Header.bCompact)), From);
+				break;
+			}
+			case MsgType::TimeSyncPing:
+				++Pings;
+				Sender.Send(Endpoint::Wrap(Id, EncodePong(Header, ReceiveNs, ++PongSequence[Id])), From);
+				break;
+			case MsgType::ModeCommand:
+			case MsgType::ConfigUpdate:
+				++Commands;
+				Sender.Send(Endpoint::Wrap(Id, EncodeCommandAck(Header, ++AckSequence[Id])), From);
+				break;
+			default:
+				++Other;	// StateAck and anything newer: nothing to answer
+				break;
+			}
+		}
+
+		const double Now = NowSeconds();
+		Sender.Flush(Now);
+
+		if (bHasPeer && StatusRate > 0.0 && Now >= NextStatus)
+		{
+			const double PoseRate = static_cast<double>(Poses - LastPoses) / std::max(Now - (NextReport - ReportInterval), 1e-3);
+			for (int Id = 0; Id < Endpoint::MaxEndpoints; ++Id)
+			{
+				if (PeerEndpoints & (1u << Id))
+				{
+					Sender.Send(Endpoint::Wrap(static_cast<uint8_t>(Id),
+						EncodeSystemStatus(++StatusSequence[Id], PoseRate, bPeerCompact)), Peer);
+				}
+			}
+			NextStatus += 1.0 / StatusRate;
+			if (NextStatus < Now) NextStatus = Now + 1.0 / StatusRate;
+		}
+
+		if (bHasPeer && StateRate > 0.0 && Now >= NextState)
+		{
+			for (int Id = 0; Id < Endpoint::MaxEndpoints; ++Id)
+			{
+				for (FArmState& Arm : ArmStates[Id])
+				{
+					if (!Arm.bValid) continue;
+
+					// Same state, the simulator's own numbering
+					FPose State = Arm.Pose;
+					State.Header.Sequence = ++Arm.Sequence;
+					Sender.Send(Endpoint::Wrap(static_cast<uint8_t>(Id), EncodeRobotState(State, State.Header.bCompact)), Arm.From);
+				}
+			}
+			NextState += 1.0 / StateRate;
+			if (NextState < Now) NextState = Now + 1.0 / StateRate;
+		}
+
+		if (Now >= NextReport)
+		{
+			std::printf("[%7.1fs] poses %8.0f/s | pings %llu | commands %llu | sent %llu, lost %llu, held back %llu | malformed %llu, ignored %llu\n",
+				Now - Start, static_cast<double>(Poses - LastPoses) / ReportInterval,
+				static_cast<unsigned long long>(Pings), static_cast<unsigned long long>(Commands),
+				static_cast<unsigned long long>(Sender.Sent), static_cast<unsigned long long>(Sender.Lost),
+				static_cast<unsigned long long>(Sender.HeldBack),
+				static_cast<unsigned long long>(Malformed), static_cast<unsigned long long>(Other));
+			std::fflush(stdout);
+			LastPoses = Poses;
+			NextReport += ReportInterval;
+		}
+	}
+
+	return 0;
+}
+
+// ============================================================================
+// load: operator stand-in measuring echo round trips
+// ============================================================================
+
+struct FArm
+{
+	uint8_t PoseType = MsgType::HandRight;
+	uint32_t NextSequence = 1;
+	uint32_t HighestEcho = 0;
+	double NextSend = 0.0;
+
+	// Send time by sequence, to match echoes
+	static constexpr uint32_t HistorySize = 8192;
+	std::vector<double> SendTimes = std::vector<double>(HistorySize, 0.0);
+	std::vector<uint32_t> SendSequences = std::vector<uint32_t>(HistorySize, 0);
+
+	uint64_t Sent = 0;
+	uint64_t Echoed = 0;
+	uint64_t Reordered = 0;
+	uint64_t Unmatched = 0;
+};
+
+static void PrintLoadStats(const char* Label, double Elapsed, uint64_t Sent, uint64_t Echoed,
+	uint64_t Reordered, const FLatencyHistogram& Rtt)
+{
+	const double LossPercent = Sent > 0 ? 100.0 * (1.0 - static_cast<double>(Echoed) / static_cast<double>(Sent)) : 0.0;
+	std::printf("%s %7.1fs | sent %8.0f/s | echoed %8.0f/s | loss %5.2f%% | reordered %llu | rtt ms min %.3f p50 %.3f p99 %.3f p99.9 %.3f max %.3f\n",
+		Label, Elapsed, static_cast<double>(Sent) / Elapsed, static_cast<double>(Echoed) / Elapsed,
+		std::max(0.0, LossPercent), static_cast<unsigned long long>(Reordered),
+		Rtt.Min * 1e3, Rtt.PercentileMs(0.5), Rtt.PercentileMs(0.99), Rtt.PercentileMs(0.999), Rtt.Max * 1e3);
+	std::fflush(stdout);
+}
+
+static int RunLoad(const FOptions& Options)
+{
+	const std::string Target = Options.Text("--target", "127.0.0.1:5010");
+	const std::string ShmName = Options.Text("--shm", "");
+	const bool bEndpoints = Options.Has("--endpoints");
+	const int MaxArms = bEndpoints ? 2 * Endpoint::MaxEndpoints : ShmName.empty() ? 1 << 16 : 2;
+	const int NumArms = std::min(MaxArms, std::max(1, static_cast<int>(Options.Number("--arms", 8))));
+	const double Rate = std::max(1.0, Options.Number("--rate", 1000.0));
+	const double Duration = Options.Number("--duration", 10.0);
+	const double ReportInterval = Options.Number("--report", 1.0);
+	const bool bCompact = Options.Has("--compact");
+
+	sockaddr_in Remote = {};
+	Remote.sin_family = AF_INET;
+	const size_t Colon = Target.rfind(':');
+	Remote.sin_port = htons(static_cast<uint16_t>(Colon == std::string::npos ? 5010 : std::atoi(Target.c_str() + Colon + 1)));
+	if (inet_pton(AF_INET, Target.substr(0, Colon).c_str(), &Remote.sin_addr) != 1)
+	{
+		std::fprintf(stderr, "Invalid target %s\n", Target.c_str());
+		return 1;
+	}
+
+	// Two arms (right + left) per channel, like one operator interface, or per endpoint on a single channel
+	std::unique_ptr<FLink> Link;
+	if (ShmName.empty())
+	{
+		Link.reset(new FUdpLink(0, bEndpoints ? 1 : (NumArms + 1) / 2, &Remote));
+	}
+	else
+	{
+		Link.reset(new FShmLink(ShmName, false, static_cast<uint32_t>(Options.Number("--ring-kb", 1024)) * 1024));
+	}
+
+	const double Start = NowSeconds();
+	const double Period = 1.0 / Rate;
+	std::vector<FArm> Arms(NumArms);
+	for (int i = 0; i < NumArms; ++i)
+	{
+		Arms[i].PoseType = (i % 2 == 0) ? MsgType::HandRight : MsgType::HandLeft;
+		Arms[i].NextSend = Start + Period * static_cast<double>(i) / NumArms;	// staggered
+	}
+
+	std::printf("loopback_sim load: %d arms at %.0f Hz -> %s (%s%s)\n",
+		NumArms, Rate, ShmName.empty() ? Target.c_str() : ("shm://" + ShmName).c_str(), bCompact ? "compact" : "msgpack",
+		bEndpoints ? ", one endpoint per arm pair" : "");
+
+	FLatencyHistogram Total, Interval;
+	uint64_t IntervalSent = 0, IntervalEchoed = 0, IntervalReordered = 0;
+	double IntervalStart = Start;
+	const double SendEnd = Start + Duration;
+	const double End = SendEnd + 0.5;	// let stragglers arrive
+	std::vector<uint8_t> Buffer(65536);
+
+	while (!bInterrupted)
+	{
+		double Now = NowSeconds();
+		if (Now >= End) break;
+
+		// Send every pose that is due
+		double NextSend = 1e300;
+		for (int i = 0; i < NumArms && Now < SendEnd; ++i)
+		{
+			FArm& Arm = Arms[i];
+			while (Arm.NextSend <= Now)
+			{
+				const uint32_t Sequence = Arm.NextSequence++;
+				std::vector<uint8_t> Bytes = EncodeHandPose(Arm.PoseType, Sequence, Now - Start, bCompact);
+				if (bEndpoints) Bytes = Endpoint::Wrap(static_cast<uint8_t>(i / 2), std::move(Bytes));
+				const uint32_t Slot = Sequence % FArm::HistorySize;
+				Arm.SendTimes[Slot] = NowSeconds();
+				Arm.SendSequences[Slot] = Sequence;
+				Link->Send(bEndpoints ? 0 : i / 2, Bytes.data(), Bytes.size(), nullptr);
+				++Arm.Sent;
+				++IntervalSent;
+
+				// Fell more than a period behind: skip ahead instead of bursting
+				Arm.NextSend += Period;
+				if (Now - Arm.NextSend > Period) Arm.NextSend = Now + Period;
+			}
+			NextSend = std::min(NextSend, Arm.NextSend);
+		}
+
+		Link->Wait(std::min({ NextSend, IntervalStart + ReportInterval, End }));
+
+		sockaddr_in From = {};
+		size_t Size = 0;
+		int Channel = 0;
+		while (Link->Receive(Buffer, Size, Channel, From))
+		{
+			const double ReceiveTime = NowSeconds();
+			const uint8_t* Message = Buffer.data();
+			size_t MessageSize = Size;
+			uint8_t Id = 0;
+			FHeader Header;
+			if (!Endpoint::Split(Message, MessageSize, Id) || !DecodeHeader(Message, MessageSize, Header)) continue;
+			if (Header.Type != MsgType::RobotStateRight && Header.Type != MsgType::RobotStateLeft) continue;
+
+			const int Pair = bEndpoints ? Id : Channel;
+			const int ArmIndex = Pair * 2 + (Header.Type == MsgType::RobotStateLeft ? 1 : 0);
+			if (ArmIndex >= NumArms) continue;
+			FArm& Arm = Arms[ArmIndex];
+
+			const uint32_t Slot = Header.Sequence % FArm::HistorySize;
+			if (Arm.SendSequences[Slot] != Header.Sequence)
+			{
+				++Arm.Unmatched;
+				continue;
+			}
+			Arm.SendSequences[Slot] = 0;	// a duplicate echo is not counted twice
+
+			if (Header.Sequence < Arm.HighestEcho)
+			{
+				++Arm.Reordered;
+				++IntervalReordered;
+			}
+			Arm.HighestEcho = std::max(Arm.HighestEcho, Header.Sequence);
+
+			const double Rtt = ReceiveTime - Arm.SendTimes[Slot];
+			Total.Add(Rtt);
+			Interval.Add(Rtt);
+			++Arm.Echoed;
+			++IntervalEchoed;
+		}
+
+		Now = NowSeconds();
+		if (Now - IntervalStart >= ReportInterval)
+		{
+			PrintLoadStats("[interval]", Now - IntervalStart, IntervalSent, IntervalEchoed, IntervalReordered, Interval);
+			Interval.Reset();
+			IntervalSent = IntervalEchoed = IntervalReordered = 0;
+			IntervalStart = Now;
+		}
+	}
+
+	uint64_t Sent = 0, Echoed = 0, Reordered = 0, Unmatched = 0;
+	for (const FArm& Arm : Arms)
+	{
+		Sent += Arm.Sent;
+		Echoed += Arm.Echoed;
+		Reordered += Arm.Reordered;
+		Unmatched += Arm.Unmatched;
+	}
+	std::printf("\n");
+	PrintLoadStats("[total]   ", std::min(NowSeconds(), SendEnd) - Start, Sent, Echoed, Reordered, Total);
+	if (Unmatched > 0)
+	{
+		std::printf("%llu echoes arrived too late to match their pose\n", static_cast<unsigned long long>(Unmatched));
+	}
+
+	return 0;
+}
+
+// ============================================================================
+
+int main(int Argc, char** Argv)
+{
+	if (Argc < 2 || (std::strcmp(Argv[1], "serve") != 0 && std::strcmp(Argv[1], "load") != 0))
+	{
+		std::fprintf(stderr, "usage: %s serve|load [options]  (see the top of LoopbackSim.cpp)\n", Argv[0]);
+		return 2;
+	}
+
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+
+	FOptions Options;
+	Options.Args.assign(Argv + 2, Argv + Argc);
+	return std::strcmp(Argv[1], "serve") == 0 ? RunServe(Options) : RunLoad(Options);
+}